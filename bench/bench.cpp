@@ -0,0 +1,751 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - microbenchmarks of the hot kernels
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include <getopt.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "../src/conf.h"
+#include "../src/dealer.h"
+#include "../src/blackjack.h"
+#include "../src/players/basic.h"
+
+// make bench runs this and writes bench.json, each kernel is warmed up and then
+// timed a number of times so we can see both the typical value and the noise
+
+namespace lbj {
+
+// access to the insides of the dealer
+class BenchBlackjack : public Blackjack {
+  public:
+    BenchBlackjack(Configuration &conf) : Blackjack(conf) { };
+
+    // one player's hand with two given cards as the current one
+    void setPlayerHand(unsigned int first, unsigned int second) {
+      playerStats.hands.resize(1);
+      playerStats.currentHand = playerStats.hands.begin();
+      playerStats.currentHand->cards.reserve(22);
+      playerStats.currentHand->cards.assign({first, second});
+      playerStats.currentHand->bet = 1;
+      playerStats.splits = 0;
+    }
+
+    void canDoubleSplit(void) {
+      can_double_split();
+    }
+
+    // the dealer starts with up and hole, hits and settles against the current hand
+    void settle(unsigned int up, unsigned int hole) {
+      hand.cards.reserve(22);
+      hand.cards.assign({up, hole});
+      nextAction = DealerAction::HitDealerHand;
+      deal();
+    }
+
+    void accumulate(int64_t outcome) {
+      n_hand++;
+      playerStats.currentOutcome = outcome;
+      updateMeanAndVariance();
+    }
+
+    double mean(void) {
+      return playerStats.mean;
+    }
+
+    double M2(void) {
+      return playerStats.M2;
+    }
+
+    size_t cards(void) {
+      return n_cards;
+    }
+
+    void accumulateLast(void) {
+      if (n_hand != 0) {
+        updateMeanAndVariance();
+      }
+    }
+};
+}
+
+struct Stats {
+  double min;
+  double median;
+  double mean;
+  double stddev;
+};
+
+static Stats statistics(std::vector<double> x) {
+  Stats s;
+  std::sort(x.begin(), x.end());
+  s.min = x.front();
+  s.median = (x.size() % 2) ? x[x.size()/2] : 0.5 * (x[x.size()/2 - 1] + x[x.size()/2]);
+  s.mean = 0;
+  for (auto v : x) {
+    s.mean += v;
+  }
+  s.mean /= x.size();
+  s.stddev = 0;
+  for (auto v : x) {
+    s.stddev += (v - s.mean) * (v - s.mean);
+  }
+  s.stddev = (x.size() > 1) ? std::sqrt(s.stddev / (x.size() - 1)) : 0;
+  return s;
+}
+
+struct Options {
+  unsigned int repeats = 7;
+  double scale = 1;
+  int cpu = -1;
+  bool scaling = false;
+  bool efficiency = false;
+  unsigned int threads = 0;
+};
+
+static Options options;
+static bool first_item = true;
+
+// the compiler cannot throw away what goes here
+static volatile double sink = 0;
+
+static void json_stats(const char *name, const char *unit, size_t n, const Stats &s) {
+  std::cout << (first_item ? "" : ",") << std::endl;
+  first_item = false;
+  std::cout << "    {\"name\": \"" << name << "\", \"unit\": \"" << unit << "\", \"iterations\": " << n
+            << ", \"min\": " << s.min << ", \"median\": " << s.median
+            << ", \"mean\": " << s.mean << ", \"stddev\": " << s.stddev << "}";
+}
+
+// runs kernel(n) once to warm up and then options.repeats times, in nanoseconds per iteration
+template <typename Kernel>
+static void bench(const char *name, size_t n, Kernel kernel) {
+  n = std::max(static_cast<size_t>(1), static_cast<size_t>(n * options.scale));
+  kernel(n);
+
+  std::vector<double> ns;
+  for (unsigned int r = 0; r < options.repeats; r++) {
+    uint64_t start = lbj::Timing::now();
+    kernel(n);
+    ns.push_back((lbj::Timing::now() - start) / static_cast<double>(n));
+  }
+  json_stats(name, "ns/op", n, statistics(ns));
+}
+
+// a configuration as if it came from the command line
+static lbj::Configuration *configuration(std::vector<std::string> args) {
+  static std::vector<std::string> storage;
+  storage = {"blackjack", "-c/dev/null", "--rng_seed=1"};
+  storage.insert(storage.end(), args.begin(), args.end());
+
+  std::vector<char *> argv;
+  for (auto &arg : storage) {
+    argv.push_back(&arg[0]);
+  }
+  argv.push_back(nullptr);
+
+  // getopt has to start all over again
+  optind = 0;
+  return new lbj::Configuration(argv.size() - 1, argv.data());
+}
+
+// what main() does, in hands per second
+static void end_to_end(const char *name, std::vector<std::string> args, size_t hands) {
+  hands = std::max(static_cast<size_t>(1), static_cast<size_t>(hands * options.scale));
+  args.push_back("--hands=" + std::to_string(hands));
+  args.push_back("--internal");
+
+  std::vector<double> hands_per_second;
+  for (unsigned int r = 0; r <= options.repeats; r++) {
+    lbj::Configuration *conf = configuration(args);
+    lbj::Blackjack *dealer = new lbj::Blackjack(*conf);
+    lbj::Basic *player = new lbj::Basic(*conf);
+    player->rules = dealer->rules();
+    dealer->setPlayer(player);
+
+    uint64_t start = lbj::Timing::now();
+    dealer->nextAction = lbj::DealerAction::StartNewHand;
+    while (!dealer->finished()) {
+      dealer->deal();
+      if (player->actionRequired != lbj::PlayerActionRequired::None) {
+        do {
+          player->play();
+        } while (dealer->process() <= 0);
+      }
+    }
+    double t = 1e-9 * (lbj::Timing::now() - start);
+
+    // the first one is the warm up
+    if (r != 0) {
+      hands_per_second.push_back(hands / t);
+    }
+
+    delete player;
+    delete dealer;
+    delete conf;
+  }
+  json_stats(name, "hands/s", hands, statistics(hands_per_second));
+}
+
+// current resident set size in kilobytes
+static long rss_kb(void) {
+  std::ifstream statm("/proc/self/statm");
+  long pages_total = 0;
+  long pages_resident = 0;
+  statm >> pages_total >> pages_resident;
+  return pages_resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// one independent simulation per thread, as a parallel run would do
+struct Worker {
+  lbj::Configuration *conf;
+  lbj::BenchBlackjack *dealer;
+  lbj::Basic *player;
+  double cpu = 0;
+};
+
+static double thread_cpu(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// nanoseconds per card without the reshuffles (which are accounted for separately)
+static double draw_ns(unsigned int decks) {
+  lbj::Configuration *conf = configuration({"--decks=" + std::to_string(decks)});
+  lbj::Blackjack dealer(*conf);
+  size_t n = std::max(static_cast<size_t>(1024), static_cast<size_t>(options.scale * (1 << 20)));
+  unsigned int sum = 0;
+  uint64_t shuffling = dealer.timing.ns[static_cast<int>(lbj::Phase::Shuffle)];
+  uint64_t start = lbj::Timing::now();
+  for (size_t i = 0; i < n; i++) {
+    sum += dealer.draw();
+  }
+  uint64_t total = lbj::Timing::now() - start;
+  shuffling = dealer.timing.ns[static_cast<int>(lbj::Phase::Shuffle)] - shuffling;
+  sink = sink + sum;
+  delete conf;
+  return static_cast<double>(total - std::min(total, shuffling)) / n;
+}
+
+static void play(Worker &worker) {
+  double start = thread_cpu();
+  worker.dealer->nextAction = lbj::DealerAction::StartNewHand;
+  while (!worker.dealer->finished()) {
+    worker.dealer->deal();
+    if (worker.player->actionRequired != lbj::PlayerActionRequired::None) {
+      do {
+        worker.player->play();
+      } while (worker.dealer->process() <= 0);
+    }
+  }
+  worker.cpu = thread_cpu() - start;
+}
+
+// an estimator takes the dealer's arguments, a rule change (for targets that are deltas) and a seed,
+// plays and returns the estimate of the target quantity (the cpu time is measured outside)
+typedef double (*Estimator)(std::vector<std::string>, const std::string &, unsigned int, size_t);
+
+// plain monte carlo, i.e. the mean of independent hands
+static double plain(std::vector<std::string> args, unsigned int seed, size_t hands) {
+  args.push_back("--rng_seed=" + std::to_string(seed));
+  args.push_back("--hands=" + std::to_string(hands));
+  Worker worker;
+  worker.conf = configuration(args);
+  worker.dealer = new lbj::BenchBlackjack(*worker.conf);
+  worker.player = new lbj::Basic(*worker.conf);
+  worker.player->rules = worker.dealer->rules();
+  worker.dealer->setPlayer(worker.player);
+  play(worker);
+
+  // the last hand is accumulated when the report is prepared
+  worker.dealer->accumulateLast();
+  double estimate = worker.dealer->mean();
+  delete worker.player;
+  delete worker.dealer;
+  delete worker.conf;
+  return estimate;
+}
+
+// the same arguments with a change appended to the rules (the last token wins)
+static std::vector<std::string> changed(std::vector<std::string> args, const std::string &change) {
+  for (auto &arg : args) {
+    if (arg.compare(0, 8, "--rules=") == 0) {
+      arg += " " + change;
+      return args;
+    }
+  }
+  args.push_back("--rules=" + change);
+  return args;
+}
+
+// the delta of a rule change out of two independent runs, one with each rule set
+static double independent(std::vector<std::string> args, const std::string &change, unsigned int seed, size_t hands) {
+  return plain(changed(args, change), 2 * seed + 1, hands) - plain(args, 2 * seed, hands);
+}
+
+// the delta of a rule change with both rule sets playing the very same rounds, as in [deltas]
+static double common_cards(std::vector<std::string> args, const std::string &change, unsigned int seed, size_t hands) {
+  args.push_back("--rng_seed=" + std::to_string(seed));
+  args.push_back("--hands=" + std::to_string(hands));
+
+  // configuration() reuses its storage so each one is built before the next
+  lbj::Configuration *conf[2];
+  lbj::Blackjack *dealer[2];
+  lbj::Basic *player[2];
+  lbj::CommonCards common;
+  for (int i = 0; i < 2; i++) {
+    conf[i] = configuration((i == 0) ? args : changed(args, change));
+    dealer[i] = new lbj::Blackjack(*conf[i]);
+    player[i] = new lbj::Basic(*conf[i]);
+    player[i]->rules = dealer[i]->rules();
+    dealer[i]->setPlayer(player[i]);
+    dealer[i]->setCommonCards(&common);
+    dealer[i]->nextAction = lbj::DealerAction::StartNewHand;
+  }
+  common.source = dealer[0];
+
+  lbj::Running delta;
+  while (true) {
+    common.round.clear();
+    for (int i = 0; i < 2; i++) {
+      lbj::play_round(*dealer[i], *player[i], conf[i]->max_incorrect_commands);
+    }
+    if (dealer[0]->finished()) {
+      break;
+    }
+    delta.add(static_cast<double>(dealer[1]->outcome() - dealer[0]->outcome()) / lbj::money_unit);
+  }
+
+  for (int i = 0; i < 2; i++) {
+    delete player[i];
+    delete dealer[i];
+    delete conf[i];
+  }
+  return delta.mean;
+}
+
+// the expected value does not depend on the rule change
+static double plain_ev(std::vector<std::string> args, const std::string &, unsigned int seed, size_t hands) {
+  return plain(args, seed, hands);
+}
+
+// error squared times cpu seconds for the same target quantity with each estimator that applies to it,
+// the error is the actual spread of independent replications, not what the report says
+static int efficiency(void) {
+
+  struct Method {
+    const char *name;
+    Estimator estimator;
+  };
+  struct Target {
+    const char *name;
+    std::vector<std::string> args;
+    std::string change;
+    std::vector<Method> methods;
+  };
+  std::vector<Target> targets = {
+    {"ev_ahc_h17_das_doa_6decks_shuffle_every_hand", {"--decks=6", "--rules=ahc h17 das doa", "--shuffle_every_hand=true"}, "", {{"plain", plain_ev}}},
+    {"ev_enhc_s17_das_doa_0decks",                   {"--decks=0", "--rules=enhc s17 das doa"}, "", {{"plain", plain_ev}}},
+    {"delta_s17_ahc_h17_das_doa_6decks",             {"--decks=6", "--rules=ahc h17 das doa"}, "s17", {{"independent", independent}, {"common_cards", common_cards}}},
+  };
+
+  unsigned int replications = std::max(3u, options.repeats);
+  size_t hands = std::max(static_cast<size_t>(1000), static_cast<size_t>(options.scale * (1 << 18)));
+
+  std::cout << "{" << std::endl;
+  std::cout << "  \"version\": \"" << PACKAGE_VERSION << "\"," << std::endl;
+  std::cout << "  \"replications\": " << replications << "," << std::endl;
+  std::cout << "  \"hands\": " << hands << "," << std::endl;
+  std::cout << "  \"targets\": [";
+  bool first_target = true;
+  for (auto &target : targets) {
+    std::cout << (first_target ? "" : ",") << std::endl;
+    first_target = false;
+    std::cout << "    {\"name\": \"" << target.name << "\", \"estimators\": [";
+
+    double reference = 0;
+    bool first_method = true;
+    for (auto &method : target.methods) {
+      std::vector<double> estimates;
+      std::vector<double> seconds;
+      for (unsigned int r = 0; r < replications; r++) {
+        double start = thread_cpu();
+        estimates.push_back(method.estimator(target.args, target.change, r + 1, hands));
+        seconds.push_back(thread_cpu() - start);
+      }
+      Stats e = statistics(estimates);
+      Stats t = statistics(seconds);
+      double work_normalized_variance = e.stddev * e.stddev * t.mean;
+      if (first_method) {
+        reference = work_normalized_variance;
+      }
+
+      std::cout << (first_method ? "" : ",") << std::endl;
+      first_method = false;
+      std::cout << "      {\"name\": \"" << method.name << "\", \"mean\": " << e.mean
+                << ", \"error\": " << e.stddev << ", \"cpu_seconds\": " << t.mean
+                << ", \"error2_cpu_seconds\": " << work_normalized_variance
+                << ", \"relative_efficiency\": " << ((work_normalized_variance > 0) ? reference / work_normalized_variance : 0) << "}";
+    }
+    std::cout << std::endl << "    ]}";
+  }
+  std::cout << std::endl << "  ]" << std::endl;
+  std::cout << "}" << std::endl;
+
+  return 0;
+}
+
+// throughput against threads, decks, penetration and shuffle_every_hand with a table
+// of where the time goes: shuffling, drawing (i.e. the rng for infinite decks) or merging
+static int scaling(void) {
+
+  unsigned int max_threads = (options.threads != 0) ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+  std::vector<unsigned int> threads;
+  for (unsigned int t = 1; t < max_threads; t *= 2) {
+    threads.push_back(t);
+  }
+  threads.push_back(max_threads);
+
+  struct Case {
+    unsigned int decks;
+    double penetration;
+    bool shuffle_every_hand;
+  };
+  std::vector<Case> cases;
+  cases.push_back({0, 0, false});
+  for (unsigned int decks : {1, 2, 6, 8}) {
+    for (double penetration : {0.5, 0.75, 0.9}) {
+      cases.push_back({decks, penetration, false});
+    }
+    cases.push_back({decks, 0.75, true});
+  }
+
+  std::cout << "# threads\tdecks\tpenetration\tshuffle_every_hand\thands_per_second\tefficiency\trss_kb_per_worker\tshuffle_share\tdraw_share\tmerge_share\tdominant" << std::endl;
+  for (auto &c : cases) {
+    double single = 0;
+    double draw_cost = draw_ns(c.decks);
+    for (auto n : threads) {
+      size_t hands = static_cast<size_t>(options.scale * (c.shuffle_every_hand ? (1 << 15) : (1 << 19)));
+      hands = std::max(static_cast<size_t>(1), hands);
+
+      long rss_before = rss_kb();
+      std::vector<Worker> workers(n);
+      for (unsigned int i = 0; i < n; i++) {
+        std::vector<std::string> args = {"--decks=" + std::to_string(c.decks),
+                                         "--hands=" + std::to_string(hands),
+                                         "--rng_seed=" + std::to_string(i + 1),
+                                         "--shuffle_every_hand=" + std::string(c.shuffle_every_hand ? "true" : "false")};
+        if (c.decks != 0) {
+          args.push_back("--penetration=" + std::to_string(c.penetration));
+        }
+        workers[i].conf = configuration(args);
+        workers[i].dealer = new lbj::BenchBlackjack(*workers[i].conf);
+        workers[i].player = new lbj::Basic(*workers[i].conf);
+        workers[i].player->rules = workers[i].dealer->rules();
+        workers[i].dealer->setPlayer(workers[i].player);
+      }
+      double kb_per_worker = static_cast<double>(rss_kb() - rss_before) / n;
+
+      uint64_t start = lbj::Timing::now();
+      std::vector<std::thread> pool;
+      for (auto &worker : workers) {
+        pool.emplace_back(play, std::ref(worker));
+      }
+      for (auto &thread : pool) {
+        thread.join();
+      }
+      uint64_t played = lbj::Timing::now();
+
+      // the same merge a parallel run needs (Chan et al.)
+      double count = 0;
+      double mean = 0;
+      double M2 = 0;
+      for (auto &worker : workers) {
+        double n_b = static_cast<double>(worker.dealer->n_hand);
+        double delta = worker.dealer->mean() - mean;
+        double total = count + n_b;
+        mean += delta * n_b / total;
+        M2 += worker.dealer->M2() + delta * delta * count * n_b / total;
+        count = total;
+      }
+      uint64_t merged = lbj::Timing::now();
+      sink = sink + mean + M2;
+
+      double wall = 1e-9 * (merged - start);
+      double hands_per_second = n * hands / wall;
+      if (n == 1) {
+        single = hands_per_second;
+      }
+
+      // shuffling is always timed, drawing (for infinite decks that is the rng) comes
+      // from the cost per card measured above, so the sampling overhead does not count
+      double cpu = 0;
+      double shuffle = 0;
+      double draw = 0;
+      for (auto &worker : workers) {
+        cpu += worker.cpu;
+        shuffle += 1e-9 * worker.dealer->timing.ns[static_cast<int>(lbj::Phase::Shuffle)];
+        draw += 1e-9 * draw_cost * worker.dealer->cards();
+      }
+      // the shuffle timer is a wall clock, so it goes with the threads' wall time (they might share a cpu)
+      double shares[] = {shuffle / (1e-9 * n * (played - start)), draw / cpu, 1e-9 * (merged - played) / wall, 0};
+      // whatever is left is the game itself (playing and settling)
+      shares[3] = std::max(0.0, 1 - shares[0] - shares[1] - shares[2]);
+      const char *names[] = {"shuffle", "draw", "merge", "game"};
+      int dominant = std::max_element(shares, shares + 4) - shares;
+
+      std::cout << n << "\t" << c.decks << "\t" << c.penetration << "\t" << c.shuffle_every_hand << "\t"
+                << hands_per_second << "\t" << ((single > 0) ? hands_per_second / (n * single) : 0) << "\t"
+                << kb_per_worker << "\t" << shares[0] << "\t" << shares[1] << "\t" << shares[2] << "\t"
+                << names[dominant] << std::endl;
+
+      for (auto &worker : workers) {
+        delete worker.player;
+        delete worker.dealer;
+        delete worker.conf;
+      }
+    }
+  }
+
+  return 0;
+}
+
+static void pin(void) {
+#ifdef __linux__
+  if (options.cpu < 0) {
+    options.cpu = sched_getcpu();
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(options.cpu, &set);
+  if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+    std::cerr << "warning: cannot pin to cpu " << options.cpu << ": " << strerror(errno) << std::endl;
+    options.cpu = -1;
+  }
+#endif
+}
+
+int main(int argc, char **argv) {
+
+  const struct option longopts[] = {
+    {"repeats", required_argument, nullptr, 'r'},
+    {"scale",   required_argument, nullptr, 's'},
+    {"cpu",     required_argument, nullptr, 'c'},
+    {"scaling", no_argument,       nullptr, 'S'},
+    {"efficiency", no_argument,    nullptr, 'E'},
+    {"threads", required_argument, nullptr, 't'},
+    {"help",    no_argument,       nullptr, 'h'},
+    {nullptr,   0,                 nullptr, 0}
+  };
+
+  int optc = 0;
+  while ((optc = getopt_long(argc, argv, "r:s:c:St:Eh", longopts, nullptr)) != -1) {
+    switch (optc) {
+      case 'r':
+        options.repeats = std::max(1, atoi(optarg));
+      break;
+      case 's':
+        options.scale = atof(optarg);
+      break;
+      case 'c':
+        options.cpu = atoi(optarg);
+      break;
+      case 'S':
+        options.scaling = true;
+      break;
+      case 't':
+        options.threads = std::max(1, atoi(optarg));
+      break;
+      case 'E':
+        options.efficiency = true;
+      break;
+      default:
+        std::cerr << "usage: " << argv[0] << " [--repeats=n] [--scale=x] [--cpu=n] [--scaling [--threads=n]] [--efficiency]" << std::endl;
+        return (optc == 'h') ? 0 : 1;
+    }
+  }
+
+  // the threads have to be free to use all the cpus
+  if (options.scaling) {
+    return scaling();
+  }
+
+  pin();
+  if (options.efficiency) {
+    return efficiency();
+  }
+
+  std::cout << "{" << std::endl;
+  std::cout << "  \"version\": \"" << PACKAGE_VERSION << "\"," << std::endl;
+  std::cout << "  \"cpu\": " << options.cpu << "," << std::endl;
+  std::cout << "  \"repeats\": " << options.repeats << "," << std::endl;
+  std::cout << "  \"kernels\": [";
+
+  // random hands of two to five cards
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<unsigned int> tags(1, 52);
+  std::vector<lbj::Hand> hands(1024);
+  for (auto &hand : hands) {
+    size_t n = 2 + rng() % 4;
+    for (size_t i = 0; i < n; i++) {
+      hand.cards.push_back(tags(rng));
+    }
+  }
+  bench("hand_value", 1 << 22, [&](size_t n) {
+    int sum = 0;
+    for (size_t i = 0; i < n; i++) {
+      sum += hands[i & 1023].value();
+    }
+    sink = sink + sum;
+  });
+
+  for (unsigned int decks : {0, 1, 2, 6, 8}) {
+    lbj::Configuration *conf = configuration({"--decks=" + std::to_string(decks)});
+    lbj::Blackjack dealer(*conf);
+    std::string name = "draw_" + std::to_string(decks) + "decks";
+    // reshuffles are included each time the shoe runs out
+    bench(name.c_str(), 1 << 22, [&](size_t n) {
+      unsigned int sum = 0;
+      for (size_t i = 0; i < n; i++) {
+        sum += dealer.draw();
+      }
+      sink = sink + sum;
+    });
+    delete conf;
+  }
+
+  for (unsigned int decks : {1, 2, 6, 8}) {
+    lbj::Configuration *conf = configuration({"--decks=" + std::to_string(decks)});
+    lbj::Blackjack dealer(*conf);
+    std::string name = "shuffle_" + std::to_string(decks) + "decks";
+    bench(name.c_str(), 1 << 14, [&](size_t n) {
+      for (size_t i = 0; i < n; i++) {
+        dealer.shuffle();
+      }
+    });
+    delete conf;
+  }
+
+  {
+    lbj::Configuration *conf = configuration({});
+    lbj::Basic player(*conf);
+    player.actionRequired = lbj::PlayerActionRequired::Play;
+
+    // every possible situation the dealer can ask about
+    struct Situation {
+      int value_player;
+      int value_dealer;
+      bool can_split;
+      bool can_double;
+    };
+    std::vector<Situation> situations;
+    for (int upcard = 2; upcard <= 11; upcard++) {
+      for (int value = 4; value <= 20; value++) {
+        situations.push_back({value, (upcard == 11) ? -11 : upcard, false, true});
+      }
+      for (int value = 13; value <= 20; value++) {
+        situations.push_back({-value, (upcard == 11) ? -11 : upcard, false, true});
+      }
+      for (int value = 4; value <= 20; value += 2) {
+        situations.push_back({value, (upcard == 11) ? -11 : upcard, true, true});
+      }
+      situations.push_back({-12, (upcard == 11) ? -11 : upcard, true, true});
+    }
+    std::shuffle(situations.begin(), situations.end(), rng);
+
+    bench("basic_play", 1 << 22, [&](size_t n) {
+      int sum = 0;
+      for (size_t i = 0; i < n; i++) {
+        const Situation &situation = situations[i % situations.size()];
+        player.value_player = situation.value_player;
+        player.value_dealer = situation.value_dealer;
+        player.can_split = situation.can_split;
+        player.can_double = situation.can_double;
+        player.play();
+        sum += static_cast<int>(player.actionTaken);
+      }
+      sink = sink + sum;
+    });
+    delete conf;
+  }
+
+  {
+    lbj::Configuration *conf = configuration({});
+    lbj::BenchBlackjack dealer(*conf);
+    lbj::Basic player(*conf);
+    dealer.setPlayer(&player);
+
+    bench("can_double_split", 1 << 22, [&](size_t n) {
+      int sum = 0;
+      for (size_t i = 0; i < n; i++) {
+        dealer.setPlayerHand(hands[i & 1023].cards[0], hands[i & 1023].cards[1]);
+        dealer.canDoubleSplit();
+        sum += player.can_double + player.can_split;
+      }
+      sink = sink + sum;
+    });
+
+    // the player stands on a hard eighteen and the dealer hits until she is done
+    bench("settlement", 1 << 20, [&](size_t n) {
+      for (size_t i = 0; i < n; i++) {
+        dealer.setPlayerHand(10, 8);
+        dealer.settle(hands[i & 1023].cards[0], hands[i & 1023].cards[1]);
+      }
+    });
+
+    std::vector<int64_t> outcomes(1024);
+    for (auto &outcome : outcomes) {
+      outcome = static_cast<int64_t>(rng() % 5) * lbj::money_unit / 2 - lbj::money_unit;
+    }
+    bench("update_mean_and_variance", 1 << 22, [&](size_t n) {
+      for (size_t i = 0; i < n; i++) {
+        dealer.accumulate(outcomes[i & 1023]);
+      }
+      sink = sink + dealer.mean();
+    });
+    delete conf;
+  }
+  std::cout << std::endl << "  ]," << std::endl;
+
+  // typical rule sets from start to end
+  first_item = true;
+  std::cout << "  \"end_to_end\": [";
+  end_to_end("ahc_h17_das_doa_6decks",   {"--decks=6", "--rules=ahc h17 das doa"}, 1 << 20);
+  end_to_end("ahc_s17_das_doa_2decks",   {"--decks=2", "--rules=ahc s17 das doa"}, 1 << 20);
+  end_to_end("ahc_h17_ndas_do9_8decks",  {"--decks=8", "--rules=ahc h17 ndas do9"}, 1 << 20);
+  end_to_end("enhc_s17_das_doa_0decks",  {"--decks=0", "--rules=enhc s17 das doa"}, 1 << 20);
+  end_to_end("ahc_h17_das_doa_6decks_shuffle_every_hand", {"--decks=6", "--rules=ahc h17 das doa", "--shuffle_every_hand=true"}, 1 << 18);
+  std::cout << std::endl << "  ]" << std::endl;
+  std::cout << "}" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,385 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - throughput of external players through pipes
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+
+#include <getopt.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "../src/timing.h"
+
+// make bench-pipe runs this and writes bench-pipe.json
+//
+// the driver sits in the middle of the dealer and an external player so it can
+// count messages and bytes in each direction and measure the time from each
+// question (bet?, insurance?, play?) to the first byte of the player's answer
+
+struct Process {
+  pid_t pid = -1;
+  int in = -1;   // what we write to
+  int out = -1;  // what we read from
+};
+
+static Process spawn(std::vector<std::string> args, std::string directory = "") {
+  Process process;
+  int to_child[2];
+  int from_child[2];
+  if (pipe(to_child) != 0 || pipe(from_child) != 0) {
+    std::cerr << "error: cannot create pipes: " << strerror(errno) << std::endl;
+    exit(1);
+  }
+
+  if ((process.pid = fork()) == 0) {
+    dup2(to_child[0], STDIN_FILENO);
+    dup2(from_child[1], STDOUT_FILENO);
+    close(to_child[0]);
+    close(to_child[1]);
+    close(from_child[0]);
+    close(from_child[1]);
+    if (directory.empty() == false && chdir(directory.c_str()) != 0) {
+      _exit(127);
+    }
+
+    std::vector<char *> argv;
+    for (auto &arg : args) {
+      argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+    execvp(argv[0], argv.data());
+    std::cerr << "error: cannot execute " << args[0] << ": " << strerror(errno) << std::endl;
+    _exit(127);
+  }
+
+  close(to_child[0]);
+  close(from_child[1]);
+  process.in = to_child[1];
+  process.out = from_child[0];
+  return process;
+}
+
+static void write_all(int fd, const char *buffer, size_t n) {
+  while (n > 0) {
+    ssize_t written = write(fd, buffer, n);
+    if (written <= 0) {
+      // the other end is gone, the main loop will notice
+      return;
+    }
+    buffer += written;
+    n -= written;
+  }
+}
+
+static bool in_path(std::string program) {
+  const char *path = getenv("PATH");
+  std::string dirs = (path != nullptr) ? path : "/usr/bin:/bin";
+  size_t start = 0;
+  while (start <= dirs.size()) {
+    size_t end = dirs.find(':', start);
+    if (end == std::string::npos) {
+      end = dirs.size();
+    }
+    std::string candidate = dirs.substr(start, end - start) + "/" + program;
+    if (access(candidate.c_str(), X_OK) == 0) {
+      return true;
+    }
+    start = end + 1;
+  }
+  return false;
+}
+
+struct Result {
+  size_t hands = 0;
+  double wall_time = 0;
+  size_t messages_dealer = 0;
+  size_t messages_player = 0;
+  size_t bytes_dealer = 0;
+  size_t bytes_player = 0;
+  size_t chunks_dealer = 0;     // i.e. reads, a message written in pieces costs more
+  size_t chunks_player = 0;
+  std::vector<double> latencies;   // in microseconds
+  int status = 0;
+};
+
+static Result run(std::string blackjack, std::vector<std::string> dealer_args, std::string player, std::string directory, size_t hands) {
+
+  Result result;
+  result.hands = hands;
+
+  dealer_args.insert(dealer_args.begin(), blackjack);
+  dealer_args.push_back("--hands=" + std::to_string(hands));
+  dealer_args.push_back("--report=" + directory + "/report.yaml");
+
+  uint64_t start = lbj::Timing::now();
+  Process dealer = spawn(dealer_args);
+  Process external = spawn({"/bin/sh", "-c", player}, directory);
+
+  std::string line_dealer;
+  std::string line_player;
+  bool pending = false;
+  uint64_t asked = 0;
+
+  struct pollfd fds[2] = {{dealer.out, POLLIN, 0}, {external.out, POLLIN, 0}};
+  char buffer[4096];
+  while (fds[0].fd >= 0) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    if (fds[0].revents != 0) {
+      ssize_t n = read(dealer.out, buffer, sizeof(buffer));
+      if (n <= 0) {
+        break;
+      }
+      // before writing, the player might even answer before write() returns
+      uint64_t forwarded = lbj::Timing::now();
+      write_all(external.in, buffer, n);
+      result.bytes_dealer += n;
+      result.chunks_dealer++;
+      for (ssize_t i = 0; i < n; i++) {
+        if (buffer[i] == '\n') {
+          result.messages_dealer++;
+          if (line_dealer.find('?') != std::string::npos) {
+            pending = true;
+            asked = forwarded;
+          }
+          line_dealer.clear();
+        } else {
+          line_dealer.push_back(buffer[i]);
+        }
+      }
+    }
+
+    if (fds[1].revents != 0) {
+      ssize_t n = read(external.out, buffer, sizeof(buffer));
+      if (n <= 0) {
+        // the player quit before the dealer, so the dealer sees the end of its input
+        fds[1].fd = -1;
+        close(dealer.in);
+        dealer.in = -1;
+        continue;
+      }
+      // the answer starts arriving now, even if it comes in pieces
+      if (pending) {
+        result.latencies.push_back(1e-3 * (lbj::Timing::now() - asked));
+        pending = false;
+      }
+      write_all(dealer.in, buffer, n);
+      result.bytes_player += n;
+      result.chunks_player++;
+      for (ssize_t i = 0; i < n; i++) {
+        if (buffer[i] == '\n') {
+          result.messages_player++;
+          line_player.clear();
+        } else {
+          line_player.push_back(buffer[i]);
+        }
+      }
+    }
+  }
+  result.wall_time = 1e-9 * (lbj::Timing::now() - start);
+
+  if (dealer.in >= 0) {
+    close(dealer.in);
+  }
+  close(dealer.out);
+  close(external.in);
+  close(external.out);
+  waitpid(dealer.pid, &result.status, 0);
+
+  // give the player some time to see the end of its input and then insist
+  int status = 0;
+  for (int i = 0; i < 100 && waitpid(external.pid, &status, WNOHANG) == 0; i++) {
+    usleep(10000);
+  }
+  if (waitpid(external.pid, &status, WNOHANG) == 0) {
+    kill(external.pid, SIGTERM);
+    waitpid(external.pid, &status, 0);
+  }
+
+  return result;
+}
+
+static double percentile(const std::vector<double> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t i = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+  return sorted[i];
+}
+
+static void json(std::string name, Result &result, bool first) {
+  std::sort(result.latencies.begin(), result.latencies.end());
+  double mean = 0;
+  for (auto latency : result.latencies) {
+    mean += latency;
+  }
+  mean = result.latencies.empty() ? 0 : mean / result.latencies.size();
+  double hands = static_cast<double>(result.hands);
+
+  std::cout << (first ? "" : ",") << std::endl;
+  std::cout << "    {\"name\": \"" << name << "\", \"hands\": " << result.hands
+            << ", \"wall_time\": " << result.wall_time
+            << ", \"hands_per_second\": " << hands / result.wall_time << "," << std::endl;
+  std::cout << "     \"messages_per_hand\": {\"dealer\": " << result.messages_dealer / hands
+            << ", \"player\": " << result.messages_player / hands << "}," << std::endl;
+  std::cout << "     \"bytes_per_hand\": {\"dealer\": " << result.bytes_dealer / hands
+            << ", \"player\": " << result.bytes_player / hands << "}," << std::endl;
+  std::cout << "     \"reads_per_hand\": {\"dealer\": " << result.chunks_dealer / hands
+            << ", \"player\": " << result.chunks_player / hands << "}," << std::endl;
+  std::cout << "     \"latency_us\": {\"decisions\": " << result.latencies.size()
+            << ", \"mean\": " << mean
+            << ", \"p50\": " << percentile(result.latencies, 0.5)
+            << ", \"p90\": " << percentile(result.latencies, 0.9)
+            << ", \"p99\": " << percentile(result.latencies, 0.99)
+            << ", \"p999\": " << percentile(result.latencies, 0.999)
+            << ", \"max\": " << (result.latencies.empty() ? 0 : result.latencies.back()) << "}," << std::endl;
+
+  // powers of two in microseconds
+  std::cout << "     \"histogram_us\": [";
+  size_t i = 0;
+  bool first_bucket = true;
+  for (double bound = 1; i < result.latencies.size(); bound *= 2) {
+    size_t count = 0;
+    while (i < result.latencies.size() && result.latencies[i] < bound) {
+      count++;
+      i++;
+    }
+    if (count != 0) {
+      std::cout << (first_bucket ? "" : ", ") << "[" << bound << ", " << count << "]";
+      first_bucket = false;
+    }
+  }
+  std::cout << "]}";
+}
+
+int main(int argc, char **argv) {
+
+  std::string blackjack = "./blackjack";
+  std::string players = "players";
+  std::string player;
+  size_t hands = 10000;
+
+  const struct option longopts[] = {
+    {"blackjack", required_argument, nullptr, 'b'},
+    {"players",   required_argument, nullptr, 'd'},
+    {"player",    required_argument, nullptr, 'p'},
+    {"hands",     required_argument, nullptr, 'n'},
+    {"help",      no_argument,       nullptr, 'h'},
+    {nullptr,     0,                 nullptr, 0}
+  };
+
+  int optc = 0;
+  while ((optc = getopt_long(argc, argv, "b:d:p:n:h", longopts, nullptr)) != -1) {
+    switch (optc) {
+      case 'b':
+        blackjack = optarg;
+      break;
+      case 'd':
+        players = optarg;
+      break;
+      case 'p':
+        player = optarg;
+      break;
+      case 'n':
+        hands = static_cast<size_t>(atof(optarg));
+      break;
+      default:
+        std::cerr << "usage: " << argv[0] << " [--blackjack=path] [--players=dir] [--hands=n] [--player=command] [-- dealer options]" << std::endl;
+        return (optc == 'h') ? 0 : 1;
+    }
+  }
+  std::vector<std::string> dealer_args(argv + optind, argv + argc);
+
+  // a dead player should not kill us
+  signal(SIGPIPE, SIG_IGN);
+
+  // the players write their own files (e.g. cards.txt) wherever they are run
+  char directory_template[] = "/tmp/blackjack-pipe-XXXXXX";
+  if (mkdtemp(directory_template) == nullptr) {
+    std::cerr << "error: cannot create temporary directory: " << strerror(errno) << std::endl;
+    return 1;
+  }
+  std::string directory = directory_template;
+
+  // relative paths have to work from the temporary directory
+  auto absolute = [](std::string path) {
+    char resolved[4096];
+    return (realpath(path.c_str(), resolved) != nullptr) ? std::string(resolved) : path;
+  };
+  blackjack = absolute(blackjack);
+  players = absolute(players);
+  std::string responder = blackjack.substr(0, blackjack.rfind('/') + 1) + "blackjack-responder";
+
+  struct Player {
+    std::string name;
+    std::string interpreter;
+    std::string command;
+    double fraction;   // of the hands, some of them are really slow
+  };
+  std::vector<Player> list;
+  if (player.empty() == false) {
+    list.push_back({"custom", "", player, 1.0});
+  } else {
+    list.push_back({"responder", "",        responder, 1.0});
+    list.push_back({"perl",      "perl",    "perl " + players + "/05-no-bust/no-bust.pl", 1.0});
+    list.push_back({"awk",       "gawk",    "gawk -f " + players + "/05-no-bust/no-bust.awk", 1.0});
+    list.push_back({"shell",     "sh",      "sh " + players + "/05-no-bust/no-bust.sh", 0.05});
+    list.push_back({"python",    "python3", "python3 " + players + "/10-random/player_random.py", 1.0});
+  }
+
+  std::cout << "{" << std::endl;
+  std::cout << "  \"players\": [";
+  bool first = true;
+  for (auto &p : list) {
+    if (p.interpreter.empty() == false && in_path(p.interpreter) == false) {
+      std::cerr << p.name << ": " << p.interpreter << " not found, skipping" << std::endl;
+      continue;
+    }
+    Result result = run(blackjack, dealer_args, p.command, directory, std::max(static_cast<size_t>(1), static_cast<size_t>(p.fraction * hands)));
+    if (WIFEXITED(result.status) == false || WEXITSTATUS(result.status) != 0) {
+      std::cerr << p.name << ": the dealer did not finish cleanly" << std::endl;
+    }
+    json(p.name, result, first);
+    first = false;
+  }
+  std::cout << std::endl << "  ]" << std::endl;
+  std::cout << "}" << std::endl;
+
+  // whatever the players left behind
+  std::string clean = "rm -rf " + directory;
+  if (system(clean.c_str()) != 0) {
+    std::cerr << "warning: could not remove " << directory << std::endl;
+  }
+
+  return 0;
+}
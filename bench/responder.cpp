@@ -0,0 +1,47 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - minimal external player for the pipe benchmark
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// the same no-bust strategy as players/05-no-bust but with as little
+// overhead as possible, so what bench/pipe.cpp measures is the protocol
+int main(void) {
+
+  char line[256];
+  while (fgets(line, sizeof(line), stdin) != nullptr) {
+    if (strncmp(line, "bet?", 4) == 0) {
+      fputs("1\n", stdout);
+    } else if (strncmp(line, "insurance?", 10) == 0) {
+      fputs("no\n", stdout);
+    } else if (strncmp(line, "play?", 5) == 0) {
+      fputs((atoi(line + 5) < 12) ? "hit\n" : "stand\n", stdout);
+    } else if (strncmp(line, "bye", 3) == 0) {
+      break;
+    } else {
+      continue;
+    }
+    fflush(stdout);
+  }
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - allocation counting for blackjack-alloc
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+#include "alloc.h"
+
+// this file is only linked into blackjack-alloc, which is built by make check
+// to make sure the hot loop does not allocate memory once it is warmed up
+
+static std::atomic<uint64_t> n_allocations{0};
+
+namespace lbj {
+uint64_t allocations(void) {
+  return n_allocations.load(std::memory_order_relaxed);
+}
+}
+
+#ifdef __GLIBC__
+// interpose the C allocator so we also see what the C++ runtime and libc do
+extern "C" {
+  void *__libc_malloc(size_t);
+  void *__libc_calloc(size_t, size_t);
+  void *__libc_realloc(void *, size_t);
+  void __libc_free(void *);
+
+  void *malloc(size_t size) {
+    n_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+  }
+
+  void *calloc(size_t n, size_t size) {
+    n_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+  }
+
+  void *realloc(void *pointer, size_t size) {
+    n_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+  }
+
+  void free(void *pointer) {
+    __libc_free(pointer);
+  }
+}
+#define LBJ_COUNT_NEW()
+#else
+// elsewhere we can only see the C++ allocations
+#define LBJ_COUNT_NEW()   n_allocations.fetch_add(1, std::memory_order_relaxed)
+#endif
+
+void *operator new(size_t size) {
+  LBJ_COUNT_NEW();
+  void *pointer = std::malloc(size ? size : 1);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  LBJ_COUNT_NEW();
+  return std::malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+  return operator new(size, tag);
+}
+
+void operator delete(void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+  std::free(pointer);
+}
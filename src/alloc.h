@@ -0,0 +1,55 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - allocation counting
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace lbj {
+
+// calls to malloc() and friends (and operator new) so far, only counted in blackjack-alloc
+uint64_t allocations(void);
+
+// remembers the count once the containers reached their final sizes
+class AllocCount {
+  public:
+    inline void newHand(size_t n) {
+      if (n == warmup) {
+        start = allocations();
+      }
+    }
+
+    size_t warmup = 10000;
+    uint64_t start = 0;
+};
+}
+
+// defined only when building blackjack-alloc for make check
+#ifdef ALLOC_COUNT
+#define LBJ_ALLOC_NEW_HAND(allocs, n)   (allocs).newHand(n)
+#else
+#define LBJ_ALLOC_NEW_HAND(allocs, n)
+#endif
+
+#endif
@@ -29,9 +29,11 @@
 #include <fstream>
 #include <algorithm>
 #include <iterator>
+#include <iomanip>
 #include <list>
 
 #include "blackjack.h"
+#include "probes.h"
 
 namespace lbj {
 Blackjack::Blackjack(Configuration &conf) : Dealer(conf), rng(dev_random()), fiftyTwoCards(1, 52) {
@@ -68,6 +70,20 @@ Blackjack::Blackjack(Configuration &conf) : Dealer(conf), rng(dev_random()), fif
 ///conf+maximum_bet+example maximum_bet = 20
   conf.set(&max_bet, {"maximum_bet", "max_bet", "maxbet"});
 
+///conf+minimum_bet+usage `minimum_bet = ` $n$
+///conf+minimum_bet+details Sets the table minimum.
+///conf+minimum_bet+details If a bet smaller than the limit is placed, the dealer answers
+///conf+minimum_bet+details `bet_minimum` and asks again. A value of 0 means no limit.
+///conf+minimum_bet+details The internal players never bet less than this value.
+///conf+minimum_bet+default $0$
+///conf+minimum_bet+example minimum_bet = 0
+///conf+minimum_bet+example minimum_bet = 5
+  conf.set(&min_bet, {"minimum_bet", "min_bet", "minbet"});
+  if (max_bet != 0 && max_bet < min_bet) {
+    std::cerr << "error: maximum_bet is less than minimum_bet" << std::endl;
+    exit(1);
+  }
+
 ///conf+rules+usage `rules = [ ahc | enhc ] [ h17 | s17 ] [ das | ndas ] [ doa | do9 ]`
 ///conf+rules+details Defines the rules of the game.
 ///conf+rules+details @
@@ -138,10 +154,12 @@ Blackjack::Blackjack(Configuration &conf) : Dealer(conf), rng(dev_random()), fif
 ///conf+blackjack_pays+usage `blackjack_pays = ` $r$
 ///conf+blackjack_pays+details Defines how much a natural pays.
 ///conf+blackjack_pays+details The real number $r$ has to be a decimal number such as `1.5` or `1.2`.
+///conf+blackjack_pays+details Money is accounted in thousandths of a unit so $r$ is rounded to three decimals.
 ///conf+blackjack_pays+default $1.5$
 ///conf+blackjack_pays+example blackjack_pays = 1.5
 ///conf+blackjack_pays+example blackjack_pays = 1.2
   conf.set(&blackjack_pays, {"blackjack_pays"});
+  blackjack_payoff = std::llround(money_unit * blackjack_pays);
 
 //  conf.set(&playerStats.bankroll, {"bankroll", "initial_bankroll"});
 
@@ -276,7 +294,7 @@ Blackjack::Blackjack(Configuration &conf) : Dealer(conf), rng(dev_random()), fif
       exit(1);
     }
     std::istringstream iss(conf.getString("cards"));
-    if (read_arranged_cards(std::move(iss)) != 0) {
+    if (read_cards(std::move(iss), arranged_cards) != 0) {
       exit(1);
     }
     conf.markUsed("cards");
@@ -304,13 +322,96 @@ Blackjack::Blackjack(Configuration &conf) : Dealer(conf), rng(dev_random()), fif
     file.close();
 
     std::istringstream iss(file_content);
-    if (read_arranged_cards(std::move(iss)) != 0) {
+    if (read_cards(std::move(iss), arranged_cards) != 0) {
       exit(1);
     }
     conf.markUsed("cards_file");
   }
   n_arranged_cards = arranged_cards.size();
 
+///conf+removed_cards+usage `removed_cards = ` $\text{list of cards}$
+///conf+removed_cards+details The cards in the list (with the same syntax as `cards`) are taken out of the shoe for the whole game.
+///conf+removed_cards+details Each entry removes one card, so `removed_cards = 5C 5C` needs at least two decks.
+///conf+removed_cards+details This option only makes sense when playing a shoe game, i.e. non-zero `decks`.
+///conf+removed_cards+details When the dealer shares its cards with other ones (i.e. `[deltas]` or `blackjack eor`), the removed cards are
+///conf+removed_cards+details instead skipped the first time they show up in each round, which is the same only if `shuffle_every_hand` is true.
+///conf+removed_cards+default Empty list
+///conf+removed_cards+example removed_cards = 5C
+///conf+removed_cards+example removed_cards = AS AH TC
+  if (conf.exists("removed_cards")) {
+    std::istringstream iss(conf.getString("removed_cards"));
+    if (read_cards(std::move(iss), removed_cards) != 0) {
+      exit(1);
+    }
+    for (auto tag : removed_cards) {
+      if (tag <= 0 || tag > 52) {
+        std::cerr << "error: removed_cards cannot have placeholders" << std::endl;
+        exit(1);
+      }
+    }
+    if (n_decks == 0 && removed_cards.empty() == false) {
+      std::cerr << "error: removed_cards needs a non-zero number of decks" << std::endl;
+      exit(1);
+    }
+    // so taking a copy of it for each round does not allocate
+    skipped_cards.reserve(removed_cards.size());
+    conf.markUsed("removed_cards");
+  }
+
+///conf+edge_profile+usage `edge_profile = ` $b$
+///conf+edge_profile+details If $b$ is `true`, the report includes a table `edge_profile` with the player's outcome binned by the count
+///conf+edge_profile+details and by the depth into the shoe at the start of each round, with the number of hands, the frequency,
+///conf+edge_profile+details the mean and the error of each bin.
+///conf+edge_profile+details The dealer keeps the count itself (with `edge_profile_count_system`) from the cards dealt since the shuffle but
+///conf+edge_profile+details the burnt ones, so it works with any player.
+///conf+edge_profile+details The depth is the fraction of the shoe already dealt (burnt cards included).
+///conf+edge_profile+details The table covers only the hands played by this process, i.e. it is neither cached nor merged.
+///conf+edge_profile+details This option only makes sense when playing a shoe game, i.e. non-zero `decks`.
+///conf+edge_profile+default `false`
+///conf+edge_profile+example edge_profile = true
+///conf+edge_profile_count_system+usage `edge_profile_count_system = ` *system*
+///conf+edge_profile_count_system+details The count the `edge_profile` is binned by, as in `count_system`.
+///conf+edge_profile_count_system+details The true count for balanced systems and the running count for unbalanced ones.
+///conf+edge_profile_count_system+default `hi-lo`
+///conf+edge_profile_count_system+example edge_profile_count_system = omega2
+///conf+edge_profile_min_count+usage `edge_profile_min_count = ` $c$
+///conf+edge_profile_min_count+details Lowest count bin of `edge_profile`, it takes every count below it as well.
+///conf+edge_profile_min_count+default $-6$
+///conf+edge_profile_min_count+example edge_profile_min_count = -10
+///conf+edge_profile_max_count+usage `edge_profile_max_count = ` $c$
+///conf+edge_profile_max_count+details Highest count bin of `edge_profile`, it takes every count above it as well.
+///conf+edge_profile_max_count+default $6$
+///conf+edge_profile_max_count+example edge_profile_max_count = 10
+///conf+edge_profile_depth_bins+usage `edge_profile_depth_bins = ` $n$
+///conf+edge_profile_depth_bins+details Number of equal depth bins of `edge_profile` from the top to the end of the shoe.
+///conf+edge_profile_depth_bins+default $10$
+///conf+edge_profile_depth_bins+example edge_profile_depth_bins = 4
+  bool edge_profile = false;
+  conf.set(&edge_profile, {"edge_profile"});
+  if (edge_profile) {
+    if (n_decks == 0) {
+      std::cerr << "error: edge_profile needs a non-zero number of decks" << std::endl;
+      exit(1);
+    }
+    std::string system = "hi-lo";
+    conf.set(system, {"edge_profile_count_system"});
+    if (profile_system.set(system, n_decks) != 0) {
+      std::cerr << "error: unknown edge_profile_count_system '" << system << "'" << std::endl;
+      exit(1);
+    }
+    int min_count = -6;
+    int max_count = 6;
+    unsigned int depth_bins = 10;
+    conf.set(&min_count, {"edge_profile_min_count"});
+    conf.set(&max_count, {"edge_profile_max_count"});
+    conf.set(&depth_bins, {"edge_profile_depth_bins"});
+    if (max_count < min_count || depth_bins == 0) {
+      std::cerr << "error: edge_profile needs edge_profile_min_count <= edge_profile_max_count and at least one depth bin" << std::endl;
+      exit(1);
+    }
+    playerStats.profile.set(min_count, max_count, depth_bins);
+  }
+
 ///conf+rng_seed+usage `rng_seed = ` $n$
 ///conf+rng_seed+details This option sets the seed of the random number generator used by the dealer to draw cards.
 ///conf+rng_seed+details This is used to get deterministic results. That is to say, the cards draw by two dealers using
@@ -321,11 +422,54 @@ Blackjack::Blackjack(Configuration &conf) : Dealer(conf), rng(dev_random()), fif
 ///conf+rng_seed+default Entropic non-deterministic random seed from C++'s `std::random_device` (most likely `/dev/random`).
 ///conf+rng_seed+example rng_seed = 1
 ///conf+rng_seed+example rng_seed = 123456
-  bool explicit_seed = conf.set(&rng_seed, {"rng_seed", "seed"});
+  explicit_seed = conf.set(&rng_seed, {"rng_seed", "seed"});
   if (explicit_seed) {
     rng = std::mt19937(rng_seed);
   }
 
+///conf+shard+usage `shard = ` $i/N$
+///conf+shard+details Plays only the $i$-th out of $N$ slices of a campaign (the first one is $i=0$), so $N$ processes
+///conf+shard+details (possibly on different machines) with the same configuration and $i = 0, \dots, N-1$ play it all.
+///conf+shard+details Each process plays its share of `hands` with its own random stream, seeded from
+///conf+shard+details `rng_seed` (which is mandatory), $i$ and $N$ through `std::seed_seq`, so shards are deterministic.
+///conf+shard+details The streams are statistically independent but they are not a partition of a single stream,
+///conf+shard+details i.e. nothing guarantees that two of them never deal the same sequence of cards (it is just extremely unlikely).
+///conf+shard+details Use `raw_report` in each shard and then `blackjack merge` to get the campaign's report.
+///conf+shard+default Empty, meaning the whole campaign is played by this process
+///conf+shard+example shard = 0/4
+///conf+shard+example shard = 15/64
+  std::string shard;
+  if (conf.set(shard, {"shard"})) {
+    char slash = 0;
+    std::istringstream iss(shard);
+    if (!(iss >> shard_index >> slash >> shard_count) || slash != '/' || shard_count == 0 || shard_index >= shard_count) {
+      std::cerr << "error: shard should be i/N with 0 <= i < N and not '" << shard << "'" << std::endl;
+      exit(1);
+    }
+    if (explicit_seed == false) {
+      std::cerr << "error: shard needs an explicit rng_seed so the shards are reproducible" << std::endl;
+      exit(1);
+    }
+
+    // the remainder goes to the last shards, one hand each
+    if (n_hands != 0) {
+      n_hands = (shard_index + 1) * n_hands / shard_count - shard_index * n_hands / shard_count;
+    }
+
+    // the sequence has a different length than the one for the results cache
+    std::seed_seq seq{rng_seed, shard_index, shard_count, 0u, 0u, 0u};
+    rng.seed(seq);
+  }
+
+  // allocate all the hands we might need up front so rare deep splits or long
+  // hands do not allocate in the middle of the run (no hand can have more than
+  // twenty-one cards plus the one that busts it)
+  hand.cards.reserve(22);
+  for (unsigned int i = 0; i <= resplits; i++) {
+    spare_hands.emplace_back();
+    spare_hands.back().cards.reserve(22);
+  }
+
   // initialize shoe and perform initial shuffle
   if (n_decks > 0) {
     shoe.reserve(52*n_decks);
@@ -334,8 +478,16 @@ Blackjack::Blackjack(Configuration &conf) : Dealer(conf), rng(dev_random()), fif
         shoe.push_back(tag);
       }
     }
+    for (auto tag : removed_cards) {
+      auto it = std::find(shoe.begin(), shoe.end(), tag);
+      if (it == shoe.end()) {
+        std::cerr << "error: there are not enough cards " << tag << " in the shoe to remove" << std::endl;
+        exit(1);
+      }
+      shoe.erase(it);
+    }
     shuffle();
-    cut_card_position = static_cast<size_t>(penetration * 52 * n_decks);
+    cut_card_position = static_cast<size_t>(penetration * shoe.size());
   }
 }
 
@@ -346,7 +498,8 @@ Blackjack::~Blackjack() {
 Player::Player(Configuration &conf) {
 ///conf+flat_bet+usage `flat_bet = ` $b$
 ///conf+flat_bet+details Tells both the dealer and the player that the betting scheme is flat or not.
-///conf+flat_bet+details The dealer will not ask for bets and the internal player, if asked, always says `1`.
+///conf+flat_bet+details The dealer will not ask for bets and bets one unit for the player.
+///conf+flat_bet+details Otherwise the internal players bet according to `betting_system`.
 ///conf+flat_bet+details The value can be either `false` or `true` or `0` or `1`.
 ///conf+flat_bet+default $false$
 ///conf+flat_bet+example flat_bet = false
@@ -366,7 +519,7 @@ Player::Player(Configuration &conf) {
   conf.set(&always_insure, {"always_insure"});  
 }
 
-int Blackjack::read_arranged_cards(std::istringstream iss) {
+int Blackjack::read_cards(std::istringstream iss, std::vector<int> &cards) {
   std::string token;
   while(iss >> token) {
 
@@ -425,11 +578,28 @@ int Blackjack::read_arranged_cards(std::istringstream iss) {
       }
     }
 
-    arranged_cards.push_back(n);
+    cards.push_back(n);
   }
   return 0;
 }
 
+// recycles a hand (list node and cards) from the spare ones so we do not allocate on each hand
+PlayerHand &Blackjack::newPlayerHand(void) {
+  if (spare_hands.empty()) {
+    spare_hands.emplace_back();
+  }
+  playerStats.hands.splice(playerStats.hands.end(), spare_hands, spare_hands.begin());
+
+  PlayerHand &player_hand = playerStats.hands.back();
+  player_hand.id = 0;
+  player_hand.bet = 0;
+  player_hand.insured = false;
+  player_hand.doubled = false;
+  player_hand.cards.clear();
+
+  return player_hand;
+}
+
 void Blackjack::can_double_split(void) {
   int n_cards = playerStats.currentHand->cards.size();
   player->can_double = (n_cards == 2);
@@ -452,35 +622,51 @@ void Blackjack::deal(void) {
   // let's start by assuming the player does not need to do anything
   player->actionRequired = lbj::PlayerActionRequired::None;
 
+  LBJ_COUNT(events.transitions[static_cast<int>(nextAction)]);
+  LBJ_TRACE(3, "state " << dealer_action_names[static_cast<int>(nextAction)]);
+
   switch(nextAction) {
     // -------------------------------------------------------------------------  
     case lbj::DealerAction::StartNewHand:
 
+      // see if somebody asked for something from outside
+      checkRequests();
+
       // check if we are done
+      if (finished()) {
+        return;
+      }
       if (n_hands > 0 && n_hand >= n_hands) {
         finished(true);
         return;
       }
 
+      // the previous round is settled now, the last one of the run is settled in prepareReport()
       if (n_hand != 0) {
+        LBJ_PROBE2(round_settled, n_hand, playerStats.currentOutcome);
         updateMeanAndVariance();
+        checkStatus();
       }
 
       if (new_hand_reset_cards) {
         i_arranged_cards = 0;
       }
+      if (common != nullptr) {
+        i_common = 0;
+        skipped_cards = removed_cards;
+      }
       playerStats.currentOutcome = 0;
       n_hand++;
+      LBJ_TIME_NEW_HAND(timing);
+      LBJ_ALLOC_NEW_HAND(allocs, n_hand);
+      LBJ_PROBE2(round_start, n_hand, playerStats.bankroll);
 
       // clear dealer's hand
       hand.cards.clear();
 
-      // erase all the player's hands, create one, add and make it the current one
-      for (auto &player_hand : playerStats.hands) {
-        player_hand.cards.clear();
-      }
-      playerStats.hands.clear();
-      playerStats.hands.push_back(std::move(PlayerHand()));
+      // give back all the player's hands, take a fresh one and make it the current one
+      spare_hands.splice(spare_hands.end(), playerStats.hands);
+      newPlayerHand();
       playerStats.currentHand = playerStats.hands.begin();
 
       // state that the player did not win anything nor split nor doubled down
@@ -495,19 +681,29 @@ void Blackjack::deal(void) {
         // burn as many cards as asked
         pos += number_of_burnt_cards;
         last_pass = false;
+
+        // the dealer's own count for edge_profile starts after the burnt cards
+        profile_count = profile_system.initial;
+        profile_pos = pos;
+        profile_shuffles = n_shuffles;
       }
 
-      info(lbj::Info::NewHand, n_hand, 1e3*playerStats.bankroll);
-#ifdef BJDEBUG
-      std::cout << "new hand #" << n_hand << std::endl;
-#endif
+      if (playerStats.profile.enabled()) {
+        profileNewRound();
+      }
+
+      // players that only follow the bankroll get this one but not every card
+      if (player->verbose || player->new_hand_info) {
+        player->info(lbj::Info::NewHand, n_hand, playerStats.bankroll);
+      }
+      LBJ_TRACE(1, "new hand #" << n_hand);
 
       if (player->flat_bet) {
 
         // TODO: check bankroll
         playerStats.currentHand->bet = player->flat_bet;
         // take player's money
-        playerStats.bankroll -= playerStats.currentHand->bet;
+        playerStats.bankroll -= money_unit * playerStats.currentHand->bet;
         if (playerStats.bankroll < playerStats.worstBankroll) {
           playerStats.worstBankroll = playerStats.bankroll;
         }
@@ -533,24 +729,18 @@ void Blackjack::deal(void) {
       // step 3. deal the first card to each player
       player_first_card = draw(&(*playerStats.currentHand));
       info(lbj::Info::CardPlayer, player_first_card);
-#ifdef BJDEBUG
-      std::cout << "first card " << card[player_first_card].utf8() << std::endl;
-#endif
+      LBJ_TRACE(2, "first card " << card[player_first_card].utf8());
       // step 4. show dealer's upcard
       dealer_up_card = draw(&hand);
       info(lbj::Info::CardDealer, dealer_up_card);
-#ifdef BJDEBUG
-      std::cout << "up card " << card[dealer_up_card].utf8() << std::endl;
-#endif
+      LBJ_TRACE(2, "up card " << card[dealer_up_card].utf8());
       player->value_dealer = hand.value();
 
       // step 5. deal the second card to each player
       player_second_card = draw(&(*playerStats.currentHand));
       info(lbj::Info::CardPlayer, player_second_card);
       player->value_player = playerStats.currentHand->value();
-#ifdef BJDEBUG
-      std::cout << "second card " << card[player_second_card].utf8() << std::endl;
-#endif
+      LBJ_TRACE(2, "second card " << card[player_second_card].utf8());
       
       if (enhc == false) {
         // step 6. deal the dealer's hole card 
@@ -568,7 +758,8 @@ void Blackjack::deal(void) {
             playerStats.currentHand->insured = true;
             // TODO: allow insurance for less than one half of the original bet
             // if the guy (girl) wants to insure, we take his (her) money
-            playerStats.bankroll -= 0.5 * playerStats.currentHand->bet;
+            playerStats.bankroll -= money_unit / 2 * playerStats.currentHand->bet;
+            playerStats.currentOutcome -= money_unit / 2 * playerStats.currentHand->bet;
             if (playerStats.bankroll < playerStats.worstBankroll) {
               playerStats.worstBankroll = playerStats.bankroll;
             }
@@ -617,38 +808,34 @@ void Blackjack::deal(void) {
           info(lbj::Info::CardDealerRevealsHole, dealer_hole_card);
         }
         info(lbj::Info::DealerBlackjack);
-#ifdef BJDEBUG
-        std::cout << "dealer blackjack " << card[dealer_hole_card].utf8() << std::endl;
-#endif
+        LBJ_TRACE(2, "dealer blackjack " << card[dealer_hole_card].utf8());
         playerStats.blackjacksDealer++;
 
         if (playerStats.currentHand->insured) {
           
           // pay him (her)
-          playerStats.bankroll += (1.0 + 0.5) * playerStats.currentHand->bet;
-          playerStats.currentOutcome += playerStats.currentHand->bet;
-          info(lbj::Info::PlayerWinsInsurance, 1e3*playerStats.currentHand->bet);
+          playerStats.bankroll += (money_unit + money_unit / 2) * playerStats.currentHand->bet;
+          playerStats.currentOutcome += (money_unit + money_unit / 2) * playerStats.currentHand->bet;
+          info(lbj::Info::PlayerWinsInsurance, money_unit * playerStats.currentHand->bet);
 
           playerStats.winsInsured++;
         }
 
         if (player_blackjack) {
           info(lbj::Info::PlayerBlackjackAlso);
-#ifdef BJDEBUG
-          std::cout << "dealer_hole_card " << card[dealer_hole_card].utf8() << std::endl;
-#endif
+          LBJ_TRACE(2, "dealer_hole_card " << card[dealer_hole_card].utf8());
 
           // give him his (her her) money back
-          playerStats.bankroll += playerStats.currentHand->bet;
-          info(lbj::Info::PlayerPushes, 1e3*playerStats.currentHand->bet);
+          playerStats.bankroll += money_unit * playerStats.currentHand->bet;
+          info(lbj::Info::PlayerPushes, money_unit * playerStats.currentHand->bet);
           
           playerStats.blackjacksPlayer++;
           playerStats.pushes++;
           
         } else {
           
-          playerStats.currentOutcome -= playerStats.currentHand->bet;
-          info(lbj::Info::PlayerLosses, 1e3*playerStats.currentHand->bet);
+          playerStats.currentOutcome -= money_unit * playerStats.currentHand->bet;
+          info(lbj::Info::PlayerLosses, money_unit * playerStats.currentHand->bet);
           
           playerStats.losses++;
         }
@@ -660,9 +847,9 @@ void Blackjack::deal(void) {
       } else if (player_blackjack) {
 
         // pay him (her)
-        playerStats.bankroll += (1.0 + blackjack_pays) * playerStats.currentHand->bet;
-        playerStats.currentOutcome += blackjack_pays * playerStats.currentHand->bet;
-        info(lbj::Info::PlayerWins, 1e3 * blackjack_pays*playerStats.currentHand->bet);
+        playerStats.bankroll += (money_unit + blackjack_payoff) * playerStats.currentHand->bet;
+        playerStats.currentOutcome += blackjack_payoff * playerStats.currentHand->bet;
+        info(lbj::Info::PlayerWins, blackjack_payoff * playerStats.currentHand->bet);
         
         playerStats.blackjacksPlayer++;
         playerStats.wins++;
@@ -686,9 +873,7 @@ void Blackjack::deal(void) {
     break;
     
     case lbj::DealerAction::AskForPlay:
-#ifdef BJDEBUG
-      std::cout << "please play" << std::endl;
-#endif
+      LBJ_TRACE(3, "please play");
       can_double_split();
       player->actionRequired = lbj::PlayerActionRequired::Play;
       nextAction = lbj::DealerAction::AskForPlay;
@@ -701,9 +886,7 @@ void Blackjack::deal(void) {
         unsigned int playerCard = draw(&(*playerStats.currentHand));
         player->value_player = playerStats.currentHand->value();
         info(lbj::Info::CardPlayer, playerCard, playerStats.currentHand->id);
-#ifdef BJDEBUG
-        std::cout << "card player " << card[playerCard].utf8() << std::endl;
-#endif
+        LBJ_TRACE(2, "card player " << card[playerCard].utf8());
 
         if (std::abs(player->value_player) == 21) {
           player->actionRequired = lbj::PlayerActionRequired::None;
@@ -729,9 +912,7 @@ void Blackjack::deal(void) {
         if (player_busted_all_hands) {
           if (enhc == false) {
             info(lbj::Info::CardDealerRevealsHole, dealer_hole_card);
-#ifdef BJDEBUG
-            std::cout << "hole " << card[dealer_hole_card].utf8() << std::endl;
-#endif
+            LBJ_TRACE(2, "hole " << card[dealer_hole_card].utf8());
           }
           playerStats.bustsPlayerAllHands++;
 
@@ -753,12 +934,12 @@ void Blackjack::deal(void) {
     break;
 
     case lbj::DealerAction::HitDealerHand:
+    {
+      LBJ_TIME_PHASE(timing, Phase::Settlement);
 
       if (enhc == false) {
         info(lbj::Info::CardDealerRevealsHole, dealer_hole_card);
-#ifdef BJDEBUG
-        std::cout << "hole " << card[dealer_hole_card].utf8() << std::endl;
-#endif
+        LBJ_TRACE(2, "hole " << card[dealer_hole_card].utf8());
       }
 
       // hit while count is less than 17 (or equal to soft 17 if hit_soft_17 is true)
@@ -766,18 +947,15 @@ void Blackjack::deal(void) {
       // while ((std::abs(dealer_value) < 17 || (h17 && dealer_value == -17)) && hand.busted() == false) {
       while (std::abs(player->value_dealer) < 17 || (h17 && player->value_dealer == -17)) {
         unsigned int dealer_card = draw(&hand);
+        LBJ_COUNT(events.dealer_hits);
         info(lbj::Info::CardDealer, dealer_card);
-#ifdef BJDEBUG
-        std::cout << "dealer " << card[dealer_card].utf8() << std::endl;
-#endif
+        LBJ_TRACE(2, "dealer " << card[dealer_card].utf8());
         player->value_dealer = hand.value();
       }
       
       if (enhc == true && hand.blackjack())  {
         info(lbj::Info::DealerBlackjack);
-#ifdef BJDEBUG
-        std::cout << "dealer blackjack " << card[dealer_hole_card].utf8() << std::endl;
-#endif
+        LBJ_TRACE(2, "dealer blackjack " << card[dealer_hole_card].utf8());
         playerStats.blackjacksDealer++;
         
         // the player loses all the hands
@@ -785,14 +963,14 @@ void Blackjack::deal(void) {
         for (auto &player_hand : playerStats.hands) {
           if (player_hand.insured) {
             // pay him (her)
-            playerStats.bankroll += (1.0 + 0.5) * player_hand.bet;
-            playerStats.currentOutcome += player_hand.bet;
-            info(lbj::Info::PlayerWinsInsurance, 1e3*playerStats.currentHand->bet);
+            playerStats.bankroll += (money_unit + money_unit / 2) * player_hand.bet;
+            playerStats.currentOutcome += (money_unit + money_unit / 2) * player_hand.bet;
+            info(lbj::Info::PlayerWinsInsurance, money_unit * player_hand.bet);
             playerStats.winsInsured++;
           }
 
-          playerStats.currentOutcome -= player_hand.bet;
-          info(lbj::Info::PlayerLosses, 1e3*player_hand.bet);
+          playerStats.currentOutcome -= money_unit * player_hand.bet;
+          info(lbj::Info::PlayerLosses, money_unit * player_hand.bet);
           playerStats.losses++;
         }
 
@@ -807,38 +985,38 @@ void Blackjack::deal(void) {
         for (const auto &playerHand : playerStats.hands) {
           if (playerHand.busted() == false) {
             // pay him (her)
-            playerStats.bankroll += 2 * playerHand.bet;
-            playerStats.currentOutcome += playerHand.bet;
-            info(lbj::Info::PlayerWins, 1e3*playerHand.bet);
+            playerStats.bankroll += 2 * money_unit * playerHand.bet;
+            playerStats.currentOutcome += money_unit * playerHand.bet;
+            info(lbj::Info::PlayerWins, money_unit * playerHand.bet);
             
             playerStats.wins++;
             playerStats.winsDoubled += playerHand.doubled;
           }
         }
       } else {
-        for (auto playerHand : playerStats.hands) {
+        for (const auto &playerHand : playerStats.hands) {
           if (playerHand.busted() == false) {  // busted hands have already been solved
             player->value_player = playerHand.value();
            
             if (std::abs(player->value_dealer) > std::abs(player->value_player)) {
                 
-              playerStats.currentOutcome -= playerHand.bet;
-              info(lbj::Info::PlayerLosses, 1e3*playerHand.bet, player->value_player);
+              playerStats.currentOutcome -= money_unit * playerHand.bet;
+              info(lbj::Info::PlayerLosses, money_unit * playerHand.bet, player->value_player);
               playerStats.losses++;
                 
             } else if (std::abs(player->value_dealer) == std::abs(player->value_player)) {
                   
               // give him his (her her) money back
-              playerStats.bankroll += playerHand.bet;
-              info(lbj::Info::PlayerPushes, 1e3*playerHand.bet);
+              playerStats.bankroll += money_unit * playerHand.bet;
+              info(lbj::Info::PlayerPushes, money_unit * playerHand.bet);
               playerStats.pushes++;
                 
             } else {
                 
               // pay him (her)  
-              playerStats.bankroll += 2 * playerHand.bet;
-              playerStats.currentOutcome += playerHand.bet;
-              info(lbj::Info::PlayerWins, 1e3*playerHand.bet, player->value_player);
+              playerStats.bankroll += 2 * money_unit * playerHand.bet;
+              playerStats.currentOutcome += money_unit * playerHand.bet;
+              info(lbj::Info::PlayerWins, money_unit * playerHand.bet, player->value_player);
               playerStats.wins++;
               playerStats.winsDoubled += playerHand.doubled;
               
@@ -850,6 +1028,7 @@ void Blackjack::deal(void) {
       player->actionRequired = lbj::PlayerActionRequired::None;
       nextAction = lbj::DealerAction::StartNewHand;
       return;
+    }
     break;
 
     case lbj::DealerAction::None:
@@ -868,6 +1047,10 @@ int Blackjack::process(void) {
   unsigned int firstCard;
   unsigned int secondCard;
     
+  LBJ_COUNT(events.actions[static_cast<int>(player->actionTaken)]);
+  LBJ_PROBE3(decision, static_cast<int>(player->actionTaken), player->value_player, player->value_dealer);
+  LBJ_TRACE(3, "command " << player_action_names[static_cast<int>(player->actionTaken)]);
+
   switch (player->actionTaken) {
 
   // we first check common commands
@@ -901,7 +1084,7 @@ int Blackjack::process(void) {
 ///ig+bankroll+name bankroll
 ///ig+bankroll+desc Ask for the player’s current bankroll
     case lbj::PlayerActionTaken::Bankroll:
-      info(lbj::Info::Bankroll, 1e3*playerStats.bankroll);  
+      info(lbj::Info::Bankroll, playerStats.bankroll);  
       return 0;
     break;  
     
@@ -915,12 +1098,19 @@ int Blackjack::process(void) {
       // TODO: bet = 0 -> wonging
       if (player->current_bet == 0) {
         info(lbj::Info::BetInvalid, player->current_bet);
+        LBJ_COUNT(events.rejected_commands);
         return 0;
       } else if (player->current_bet < 0) {
         info(lbj::Info::BetInvalid, player->current_bet);
+        LBJ_COUNT(events.rejected_commands);
+        return 0;
+      } else if (player->current_bet < min_bet) {
+        info(lbj::Info::BetInvalid, player->current_bet, min_bet);
+        LBJ_COUNT(events.rejected_commands);
         return 0;
       } else if (max_bet != 0  && player->current_bet > max_bet) {
         info(lbj::Info::BetInvalid, player->current_bet);
+        LBJ_COUNT(events.rejected_commands);
         return 0;
       } else {
           
@@ -929,7 +1119,7 @@ int Blackjack::process(void) {
         playerStats.currentHand->bet = player->current_bet;
           
         // and take his (her) money
-        playerStats.bankroll -= playerStats.currentHand->bet;
+        playerStats.bankroll -= money_unit * playerStats.currentHand->bet;
         if (playerStats.bankroll < playerStats.worstBankroll) {
           playerStats.worstBankroll = playerStats.bankroll;
         }
@@ -944,7 +1134,8 @@ int Blackjack::process(void) {
     case lbj::PlayerActionTaken::Insure:
       // TODO: allow insurance for less than one half of the original bet
       // take his (her) money
-      playerStats.bankroll -= 0.5 * playerStats.currentHand->bet;
+      playerStats.bankroll -= money_unit / 2 * playerStats.currentHand->bet;
+      playerStats.currentOutcome -= money_unit / 2 * playerStats.currentHand->bet;
       if (playerStats.bankroll < playerStats.worstBankroll) {
         playerStats.worstBankroll = playerStats.bankroll;
       }
@@ -990,7 +1181,7 @@ int Blackjack::process(void) {
 
         // TODO: check bankroll
         // take his (her) money
-        playerStats.bankroll -= playerStats.currentHand->bet;
+        playerStats.bankroll -= money_unit * playerStats.currentHand->bet;
         if (playerStats.bankroll < playerStats.worstBankroll) {
           playerStats.worstBankroll = playerStats.bankroll;
         }
@@ -1005,8 +1196,8 @@ int Blackjack::process(void) {
         info(lbj::Info::CardPlayer, playerCard, playerStats.currentHand->id);
         
         if (playerStats.currentHand->busted()) {
-          info(lbj::Info::PlayerLosses, 1e3*playerStats.currentHand->bet, player->value_player);
-          playerStats.currentOutcome -= playerStats.currentHand->bet;
+          info(lbj::Info::PlayerLosses, money_unit * playerStats.currentHand->bet, player->value_player);
+          playerStats.currentOutcome -= money_unit * playerStats.currentHand->bet;
           playerStats.bustsPlayer++;
           playerStats.losses++;
         }
@@ -1018,6 +1209,7 @@ int Blackjack::process(void) {
       } else {
           
         info(lbj::Info::PlayerDoubleInvalid);
+        LBJ_COUNT(events.rejected_commands);
         return -1;
           
       }
@@ -1038,7 +1230,7 @@ int Blackjack::process(void) {
       if (playerStats.splits < resplits && playerStats.currentHand->cards.size() == 2 && card[firstCard].value == card[secondCard].value) {
         
         // take player's money
-        playerStats.bankroll -= playerStats.currentHand->bet;
+        playerStats.bankroll -= money_unit * playerStats.currentHand->bet;
         if (playerStats.bankroll < playerStats.worstBankroll) {
           playerStats.worstBankroll = playerStats.bankroll;
         }
@@ -1049,15 +1241,16 @@ int Blackjack::process(void) {
         
         // mark that we split to put ids in the hands and to limi the number of spltis
         playerStats.splits++;
+        LBJ_COUNT(events.splits[std::min(playerStats.splits, static_cast<unsigned int>(Events::max_split_depth))]);
 
         // the first hand is id=1, the rest have the id of the size of the list
         if (playerStats.currentHand == playerStats.hands.begin()) {
           playerStats.currentHand->id = 1;
         }
         
-        // create a new hand
-        PlayerHand newHand;
-        newHand.id = playerStats.hands.size() + 1;
+        // create a new hand at the end of the list of hands
+        PlayerHand &newHand = newPlayerHand();
+        newHand.id = playerStats.hands.size();
         newHand.bet = playerStats.currentHand->bet;
         
         // remove second the card from the first hand
@@ -1066,9 +1259,6 @@ int Blackjack::process(void) {
         // and put it into the second hand
         newHand.cards.push_back(secondCard);
 
-        // add the new hand to the list of hands        
-        playerStats.hands.push_back(std::move(newHand));
-
         // tell the player what the ids are
         info(lbj::Info::PlayerSplitIds, playerStats.currentHand->id, newHand.id);
         
@@ -1111,6 +1301,7 @@ int Blackjack::process(void) {
       } else {
 
         info(lbj::Info::PlayerSplitInvalid);
+        LBJ_COUNT(events.rejected_commands);
         return -1;
           
       }
@@ -1127,8 +1318,8 @@ int Blackjack::process(void) {
 
       if (playerStats.currentHand->busted()) {
           
-        playerStats.currentOutcome -= playerStats.currentHand->bet;
-        info(lbj::Info::PlayerLosses, 1e3*playerStats.currentHand->bet);
+        playerStats.currentOutcome -= money_unit * playerStats.currentHand->bet;
+        info(lbj::Info::PlayerLosses, money_unit * playerStats.currentHand->bet);
         playerStats.bustsPlayer++;
         playerStats.losses++;
 
@@ -1155,6 +1346,7 @@ int Blackjack::process(void) {
     default:
 
       info(lbj::Info::CommandInvalid);
+      LBJ_COUNT(events.rejected_commands);
       return -1;
   
     break;
@@ -1166,21 +1358,73 @@ int Blackjack::process(void) {
 
 void Blackjack::shuffle() {
     
+  LBJ_TIME_PHASE_ALWAYS(timing, Phase::Shuffle);
+
   // for infinite decks there is no need to shuffle (how would one do it?)
   // we just pick a random card when we need to deal and that's it
   if (n_decks > 0) {
+    LBJ_PROBE1(shuffle_start, n_decks);
     std::shuffle(shoe.begin(), shoe.end(), rng);
     pos = 0;
     i_arranged_cards = 0;
     n_shuffles++;
+    LBJ_PROBE1(shuffle_end, n_shuffles);
   }
   
   return;
 }
 
 
+// bin the round that is about to start by the count of the cards seen so far and the depth into the shoe
+void Blackjack::profileNewRound(void) {
+  // if the shoe ran out in the middle of the last round it was shuffled without burning cards
+  if (n_shuffles != profile_shuffles) {
+    profile_count = profile_system.initial;
+    profile_pos = 0;
+    profile_shuffles = n_shuffles;
+  }
+  for (; profile_pos < pos; profile_pos++) {
+    profile_count += profile_system.weight[shoe[profile_pos]];
+  }
+
+  double left = static_cast<double>(shoe.size() - pos);
+  double count = (profile_system.balanced == false) ? profile_count : ((left > 0) ? 52.0 * profile_count / left : 0);
+  playerStats.profile.start(count, pos / static_cast<double>(shoe.size()));
+  return;
+}
+
 unsigned int Blackjack::draw(Hand *hand) {
     
+  LBJ_TIME_PHASE(timing, Phase::Draw);
+  n_cards++;
+
+  unsigned int tag = 0;
+  if (common == nullptr) {
+    tag = nextCard();
+  } else {
+    tag = common->card(i_common++);
+    // the first one of each removed card in the round is not for us
+    for (auto it = skipped_cards.begin(); it != skipped_cards.end(); ) {
+      if (static_cast<unsigned int>(*it) == tag) {
+        skipped_cards.erase(it);
+        tag = common->card(i_common++);
+        it = skipped_cards.begin();
+      } else {
+        ++it;
+      }
+    }
+  }
+    
+  if (hand != nullptr) {
+    hand->cards.push_back(tag);
+  }
+  LBJ_PROBE2(card_drawn, tag, pos);
+  
+  return tag;
+}
+
+unsigned int Blackjack::nextCard(void) {
+
   unsigned int tag = 0; 
 
   if (n_decks == 0) {
@@ -1191,6 +1435,9 @@ unsigned int Blackjack::draw(Hand *hand) {
       // negative (or invalid) values are placeholder for random cards  
       if ((tag = arranged_cards[i_arranged_cards++]) <= 0 || tag > 52) {
         tag = fiftyTwoCards(rng);
+        LBJ_COUNT(events.arranged_misses);
+      } else {
+        LBJ_COUNT(events.arranged_hits);
       }
       
       if (quit_when_arranged_cards_run_out && i_arranged_cards == n_arranged_cards) {
@@ -1202,12 +1449,15 @@ unsigned int Blackjack::draw(Hand *hand) {
       
     if (n_arranged_cards == 0 || i_arranged_cards >= n_arranged_cards) {
       last_pass = (pos >= cut_card_position) || shuffle_every_hand;
-      if (pos >= 52 * n_decks) {
+      if (pos >= shoe.size()) {
+        // the shoe ran out in the middle of a round, counters have to start over
+        info(lbj::Info::Shuffle);
         shuffle();
       }
     
     } else {
       if ((tag = arranged_cards[i_arranged_cards++]) > 0 && tag < 52) {
+        LBJ_COUNT(events.arranged_hits);
 
         // find the original position of the card tag
         auto it = std::find(shoe.begin() + pos, shoe.end(), tag);
@@ -1225,19 +1475,62 @@ unsigned int Blackjack::draw(Hand *hand) {
           std::cerr << "error: no more cards " << tag << " in the shoe" << std::endl;
           exit(1);
         }
+      } else {
+        LBJ_COUNT(events.arranged_misses);
       }
     }
     tag = shoe[pos++];
     
   }
-    
-  if (hand != nullptr) {
-    hand->cards.push_back(tag);
-  }
   
   return tag;
 }
 
+void Blackjack::reseed(size_t stream) {
+  if (explicit_seed) {
+    std::seed_seq seq{rng_seed, static_cast<unsigned int>(stream), static_cast<unsigned int>(stream >> 32)};
+    rng.seed(seq);
+    if (n_decks > 0) {
+      shuffle();
+    }
+  }
+  return;
+}
+
+std::string Blackjack::signature(void) {
+  std::ostringstream oss;
+  oss << std::setprecision(17);
+  oss << "dealer = blackjack" << std::endl;
+  oss << "rules = " << rules() << std::endl;
+  oss << "blackjack_pays = " << blackjack_pays << std::endl;
+  oss << "maximum_bet = " << max_bet << std::endl;
+  if (min_bet != 0) {
+    oss << "minimum_bet = " << min_bet << std::endl;
+  }
+  oss << "number_of_burnt_cards = " << number_of_burnt_cards << std::endl;
+  oss << "penetration = " << penetration << std::endl;
+  oss << "penetration_sigma = " << penetration_sigma << std::endl;
+  oss << "shuffle_every_hand = " << shuffle_every_hand << std::endl;
+  oss << "new_hand_reset_cards = " << new_hand_reset_cards << std::endl;
+  oss << "dealer_draws_even_if_player_busted = " << dealer_draws_even_if_player_busted << std::endl;
+  if (quit_when_arranged_cards_run_out) {
+    oss << "quit_when_arranged_cards_run_out = " << quit_when_arranged_cards_run_out << std::endl;
+  }
+  oss << "cards =";
+  for (auto tag : arranged_cards) {
+    oss << " " << tag;
+  }
+  oss << std::endl;
+  if (removed_cards.empty() == false) {
+    oss << "removed_cards =";
+    for (auto tag : removed_cards) {
+      oss << " " << tag;
+    }
+    oss << std::endl;
+  }
+  return oss.str();
+}
+
 std::string Blackjack::rules(void) {
   return ((enhc) ? "enhc" : "ahc")  + std::string(" ") +
          ((h17)  ? "h17"  : "s17")  + std::string(" ") +
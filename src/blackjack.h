@@ -28,6 +28,17 @@
 
 namespace lbj {
 
+class Blackjack;
+
+// the cards of a round shared by several dealers that play it under different rules
+// (common random numbers), they come from the source's shoe as the first one who needs them asks
+struct CommonCards {
+  Blackjack *source = nullptr;
+  std::vector<unsigned int> round;
+
+  inline unsigned int card(size_t i);
+};
+
 class Blackjack : public Dealer {
   public:  
     Blackjack(Configuration &);
@@ -38,11 +49,21 @@ class Blackjack : public Dealer {
     void deal(void) override;
     int process(void) override;
     std::string rules(void) override;
+    std::string signature(void) override;
+    void reseed(size_t) override;
+
+    // draw from the given common cards instead of from our own shoe
+    void setCommonCards(CommonCards *c) {
+      common = c;
+    }
     
+  protected:
+    void can_double_split(void);
     
   private:
     
     unsigned int rng_seed;
+    bool explicit_seed = false;
     std::random_device dev_random;
     std::mt19937 rng;
     std::uniform_int_distribution<unsigned int> fiftyTwoCards;
@@ -72,17 +93,49 @@ class Blackjack : public Dealer {
     size_t i_arranged_cards = 0;
 
     unsigned int resplits = 3;
+    unsigned int min_bet = 0;
     unsigned int max_bet = 0;
     unsigned int number_of_burnt_cards = 0;
     
     double insurance = 0;
     double blackjack_pays = 1.5;
+    int64_t blackjack_payoff = 1500;  // in money_unit, per unit bet
     
     double penetration = 0.75;
     double penetration_sigma = 0;
     
-    int read_arranged_cards(std::istringstream iss); // maybe this should go into the parent class?
-    void can_double_split(void);
+    // the player's hands go back here after each hand and are taken again when needed
+    std::list<PlayerHand> spare_hands;
+    PlayerHand &newPlayerHand(void);
+
+    // cards taken out of the shoe (or skipped once per round when sharing common cards)
+    std::vector<int> removed_cards;
+    std::vector<int> skipped_cards;
+
+    int read_cards(std::istringstream iss, std::vector<int> &); // maybe this should go into the parent class?
+
+    // the dealer's own count for edge_profile
+    CountSystem profile_system;
+    int profile_count = 0;
+    size_t profile_pos = 0;
+    size_t profile_shuffles = 0;
+    void profileNewRound(void);
+
+    // the next card out of the shoe (or the infinite deck), arranged or not
+    unsigned int nextCard(void);
+    friend struct CommonCards;
+    CommonCards *common = nullptr;
+    size_t i_common = 0;
 };
+
+unsigned int CommonCards::card(size_t i) {
+  while (round.size() <= i) {
+    round.push_back(source->nextCard());
+  }
+  return round[i];
+}
+
+// play one round, i.e. from a new hand up to the point where the next one would start, see deltas.cpp
+int play_round(Blackjack &, Player &, unsigned int);
 };
 #endif
@@ -0,0 +1,379 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - persistent results cache and mergeable raw reports
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+#include "dealer.h"
+
+namespace lbj {
+
+// 64-bit FNV-1a, we need something stable across platforms and compilers
+static std::string fnv1a(const std::string &s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  std::ostringstream oss;
+  oss << std::hex << std::setw(16) << std::setfill('0') << h;
+  return oss.str();
+}
+
+// counters that just add up when merging two runs
+std::list<std::pair<std::string, uint64_t *>> Dealer::counters(void) {
+  return {
+    {"hands_insured",          &playerStats.handsInsured},
+    {"hands_doubled",          &playerStats.handsDoubled},
+    {"blackjacks_player",      &playerStats.blackjacksPlayer},
+    {"blackjacks_dealer",      &playerStats.blackjacksDealer},
+    {"busts_player",           &playerStats.bustsPlayer},
+    {"busts_player_all_hands", &playerStats.bustsPlayerAllHands},
+    {"busts_dealer",           &playerStats.bustsDealer},
+    {"wins",                   &playerStats.wins},
+    {"wins_insured",           &playerStats.winsInsured},
+    {"wins_doubled",           &playerStats.winsDoubled},
+    {"wins_blackjack",         &playerStats.winsBlackjack},
+    {"pushes",                 &playerStats.pushes},
+    {"losses",                 &playerStats.losses},
+  };
+}
+
+// what we need to merge two runs, with money in units so files are human-readable
+std::map<std::string, double> Dealer::accumulators(void) {
+  std::map<std::string, double> a;
+  a["hands"] = static_cast<double>(n_hand);
+  a["mean"] = playerStats.mean;
+  a["M2"] = playerStats.M2;
+  a["bankroll"] = playerStats.bankroll / static_cast<double>(money_unit);
+  a["worst_bankroll"] = playerStats.worstBankroll / static_cast<double>(money_unit);
+  a["total_money_waged"] = static_cast<double>(playerStats.totalMoneyWaged);
+  for (auto &counter : counters()) {
+    a[counter.first] = static_cast<double>(*counter.second);
+  }
+  return a;
+}
+
+// empty if the player cannot be described, i.e. if we cannot tell whether two runs are the same
+std::string Dealer::hash(void) {
+  std::string player_signature = player->signature();
+  return player_signature.empty() ? "" : fnv1a(signature() + "\n" + player_signature);
+}
+
+// merges the run b into a as if b had been played right after a:
+// Chan et al's parallel algorithm for the mean and the variance,
+// the worst bankroll of b is shifted by the final bankroll of a
+// and whatever else (the counters) just adds up
+static void merge_accumulators(std::map<std::string, double> &a, const std::map<std::string, double> &b) {
+
+  double n_a = a["hands"];
+  double n_b = b.at("hands");
+  if (n_b == 0) {
+    return;
+  } else if (n_a == 0) {
+    a = b;
+    return;
+  }
+
+  double delta = b.at("mean") - a["mean"];
+  a["mean"] += delta * n_b / (n_a + n_b);
+  a["M2"] += b.at("M2") + delta * delta * n_a * n_b / (n_a + n_b);
+  a["worst_bankroll"] = std::min(a["worst_bankroll"], a["bankroll"] + b.at("worst_bankroll"));
+
+  for (const auto &item : b) {
+    if (item.first != "mean" && item.first != "M2" && item.first != "worst_bankroll" && item.first.compare(0, 6, "shard_") != 0) {
+      a[item.first] += item.second;
+    }
+  }
+
+  return;
+}
+
+// a simple key: value yaml, we only keep the hash as a string
+static int read_accumulators(const std::string &path, std::map<std::string, double> &a, std::string &hash) {
+
+  // std::ifstream is RAII, i.e. no need to call close
+  std::ifstream file_stream(path);
+  if (!file_stream.is_open()) {
+    return 1;
+  }
+
+  std::string line;
+  int line_num = 0;
+  while (getline(file_stream, line)) {
+    line_num++;
+    if (line.empty() || line == "---" || line == "...") {
+      continue;
+    }
+
+    std::size_t delimiter_pos = line.find(":");
+    if (delimiter_pos == std::string::npos) {
+      std::cerr << "error: cannot find ':' in " << path << ":" << line_num << std::endl;
+      return -1;
+    }
+    std::string key = line.substr(0, delimiter_pos);
+    std::string value = line.substr(delimiter_pos + 1);
+    if (key == "hash") {
+      std::size_t first = value.find('"');
+      std::size_t last = value.rfind('"');
+      hash = (first != last) ? value.substr(first + 1, last - first - 1) : "";
+      continue;
+    }
+    try {
+      a[key] = std::stod(value);
+    } catch (...) {
+      std::cerr << "error: invalid value in " << path << ":" << line_num << std::endl;
+      return -1;
+    }
+  }
+  if (a.count("hands") == 0 || a.count("mean") == 0 || a.count("M2") == 0) {
+    std::cerr << "error: " << path << " does not have hands, mean and M2" << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
+
+// write to a temporary file and then rename so nobody ever reads half a file
+// (runs sharing a results cache file also need the lock, see readResultsCache())
+static int write_accumulators(const std::string &path, const std::string &hash, const std::map<std::string, double> &a) {
+
+  std::string tmp_path = path + ".tmp";
+  std::ofstream file_stream(tmp_path);
+  if (!file_stream.is_open()) {
+    std::cerr << "error: could not open file " << tmp_path << std::endl;
+    return -1;
+  }
+
+  // the main ones first so a human can find them
+  const char *first[] = {"shard_index", "shard_count", "hands", "mean", "M2", "bankroll", "worst_bankroll", "total_money_waged"};
+  file_stream << std::setprecision(17);
+  file_stream << "---" << std::endl;
+  if (hash.empty() == false) {
+    file_stream << "hash: \"" << hash << "\"" << std::endl;
+  }
+  for (auto key : first) {
+    if (a.count(key) != 0) {
+      file_stream << key << ": " << a.at(key) << std::endl;
+    }
+  }
+  for (const auto &item : a) {
+    if (std::find(std::begin(first), std::end(first), item.first) == std::end(first)) {
+      file_stream << item.first << ": " << item.second << std::endl;
+    }
+  }
+  file_stream << "..." << std::endl;
+  file_stream.close();
+
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::cerr << "error: could not write file " << path << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
+
+int Dealer::readResultsCache(void) {
+
+  if (results_cache_path.empty()) {
+    return 0;
+  }
+
+  results_cache_hash = hash();
+  if (results_cache_hash.empty()) {
+    std::cerr << "error: results_cache can only be used with the internal player" << std::endl;
+    return -1;
+  }
+  if (shard_count != 0) {
+    std::cerr << "error: results_cache cannot be used together with shard, use raw_report and merge instead" << std::endl;
+    return -1;
+  }
+  results_cache_file = results_cache_path + "/" + results_cache_hash + ".yaml";
+
+  // two runs with the same signature would both start from the same accumulators and the
+  // last one to write would throw away the hands of the other, so we hold a lock from now
+  // until the process ends and the next one tops up whatever we leave (the lock is on a
+  // sibling file because the cache file itself is replaced when written)
+  std::string lock_path = results_cache_path + "/" + results_cache_hash + ".lock";
+  if ((results_cache_lock = open(lock_path.c_str(), O_RDWR | O_CREAT, 0644)) < 0) {
+    std::cerr << "error: could not open file " << lock_path << ": " << strerror(errno) << std::endl;
+    return -1;
+  }
+  if (flock(results_cache_lock, LOCK_EX | LOCK_NB) != 0) {
+    std::cerr << "waiting for another run with the same configuration to finish with " << results_cache_file << std::endl;
+    while (flock(results_cache_lock, LOCK_EX) != 0) {
+      if (errno != EINTR) {
+        std::cerr << "error: could not lock file " << lock_path << ": " << strerror(errno) << std::endl;
+        return -1;
+      }
+    }
+  }
+
+  std::string file_hash;
+  int result = read_accumulators(results_cache_file, cached, file_hash);
+  if (result > 0) {
+    // first run with this signature
+    return 0;
+  } else if (result < 0) {
+    return -1;
+  }
+  n_hands_cached = static_cast<size_t>(cached["hands"]);
+
+  // hands is the total we want, so we only play the missing ones
+  if (n_hands != 0) {
+    if (n_hands <= n_hands_cached) {
+      finished(true);
+    } else {
+      n_hands -= n_hands_cached;
+    }
+  }
+
+  // do not replay the very same cards if the seed was given
+  if (n_hands_cached != 0) {
+    reseed(n_hands_cached);
+  }
+
+  return 0;
+}
+
+void Dealer::mergeResultsCache(void) {
+
+  if (n_hands_cached == 0) {
+    return;
+  }
+
+  // the cached run goes first
+  std::map<std::string, double> merged = cached;
+  merge_accumulators(merged, accumulators());
+
+  n_hand = static_cast<size_t>(merged["hands"]);
+  playerStats.mean = merged["mean"];
+  playerStats.M2 = merged["M2"];
+  playerStats.mean_c = 0;
+  playerStats.M2_c = 0;
+  playerStats.variance = (n_hand > 1) ? playerStats.M2 / (double)(n_hand-1) : 0;
+
+  for (auto &counter : counters()) {
+    *counter.second = static_cast<uint64_t>(merged[counter.first]);
+  }
+  // the file has money in units, we keep it in thousandths
+  playerStats.bankroll = std::llround(money_unit * merged["bankroll"]);
+  playerStats.worstBankroll = std::llround(money_unit * merged["worst_bankroll"]);
+  playerStats.totalMoneyWaged = static_cast<uint64_t>(merged["total_money_waged"]);
+
+  return;
+}
+
+int Dealer::writeResultsCache(void) {
+
+  if (results_cache_file.empty()) {
+    return 0;
+  }
+
+  return write_accumulators(results_cache_file, results_cache_hash, accumulators());
+}
+
+int Dealer::writeRawReport(void) {
+
+  if (raw_report_path.empty()) {
+    return 0;
+  }
+
+  std::map<std::string, double> a = accumulators();
+  if (shard_count != 0) {
+    a["shard_index"] = shard_index;
+    a["shard_count"] = shard_count;
+  }
+
+  return write_accumulators(raw_report_path, hash(), a);
+}
+
+// blackjack merge [options] file1 file2 ...
+// the files are merged in the given order into the cache, so the usual
+// report (with the rules given in the options) is written as if they had
+// been the results of a previous run with the very same configuration
+int Dealer::mergeRawReports(const std::list<std::string> &paths) {
+
+  if (paths.empty()) {
+    std::cerr << "error: merge needs at least one raw report" << std::endl;
+    return -1;
+  }
+
+  std::string expected_hash = hash();
+  std::vector<bool> shards;
+  for (const auto &path : paths) {
+    std::map<std::string, double> a;
+    std::string file_hash;
+    if (read_accumulators(path, a, file_hash) != 0) {
+      std::cerr << "error: cannot read raw report " << path << std::endl;
+      return -1;
+    }
+
+    // we can only tell if both the files and we know what the configuration is
+    if (expected_hash.empty() == false && file_hash.empty() == false && file_hash != expected_hash) {
+      std::cerr << "error: " << path << " was not obtained with this configuration" << std::endl;
+      return -1;
+    }
+
+    if (a.count("shard_count") != 0) {
+      size_t count = static_cast<size_t>(a["shard_count"]);
+      size_t index = static_cast<size_t>(a["shard_index"]);
+      if (shards.empty()) {
+        shards.resize(count, false);
+      } else if (shards.size() != count) {
+        std::cerr << "error: " << path << " has " << count << " shards but the previous ones had " << shards.size() << std::endl;
+        return -1;
+      }
+      if (index >= count || shards[index]) {
+        std::cerr << "error: shard " << index << " of " << path << " is duplicated or out of range" << std::endl;
+        return -1;
+      }
+      shards[index] = true;
+    }
+
+    merge_accumulators(cached, a);
+    n_merged++;
+  }
+
+  size_t missing = std::count(shards.begin(), shards.end(), false);
+  if (missing != 0) {
+    std::cerr << "warning: " << missing << " out of " << shards.size() << " shards are missing" << std::endl;
+  }
+
+  n_hands_cached = static_cast<size_t>(cached["hands"]);
+  finished(true);
+
+  return 0;
+}
+}
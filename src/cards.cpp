@@ -20,6 +20,9 @@
  *------------------- ------------  ----    --------  --     -       -         -
  */
 
+#include <sstream>
+#include <algorithm>
+
 #include "dealer.h"
 
 namespace lbj {
@@ -134,4 +137,54 @@ Card card[53] = { 0,
                  14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,
                  27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
                  40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52};
-}
\ No newline at end of file
+
+int CountSystem::set(const std::string &spec, unsigned int n_decks) {
+
+  // weights of A 2 3 4 5 6 7 8 9 T
+  int w[10];
+  initial = 0;
+  if (spec == "hi-lo" || spec == "hilo") {
+    int hilo[10] = {-1, 1, 1, 1, 1, 1, 0, 0, 0, -1};
+    std::copy(hilo, hilo + 10, w);
+  } else if (spec == "ko") {
+    int ko[10] = {-1, 1, 1, 1, 1, 1, 1, 0, 0, -1};
+    std::copy(ko, ko + 10, w);
+    // so the key counts do not depend on the number of decks
+    initial = 4 - 4 * static_cast<int>(n_decks);
+  } else if (spec == "omega2" || spec == "omega-ii") {
+    int omega2[10] = {0, 1, 1, 2, 2, 2, 1, 0, -1, -2};
+    std::copy(omega2, omega2 + 10, w);
+  } else if (spec == "hi-opt1" || spec == "hi-opt-i") {
+    int hiopt1[10] = {0, 0, 1, 1, 1, 1, 0, 0, 0, -1};
+    std::copy(hiopt1, hiopt1 + 10, w);
+  } else if (spec == "hi-opt2" || spec == "hi-opt-ii") {
+    int hiopt2[10] = {0, 1, 1, 2, 2, 1, 1, 0, 0, -2};
+    std::copy(hiopt2, hiopt2 + 10, w);
+  } else if (spec == "zen") {
+    int zen[10] = {-1, 1, 1, 2, 2, 2, 1, 0, 0, -2};
+    std::copy(zen, zen + 10, w);
+  } else {
+    std::istringstream iss(spec);
+    for (int i = 0; i < 10; i++) {
+      if (!(iss >> w[i])) {
+        return -1;
+      }
+    }
+    std::string extra;
+    if (iss >> extra) {
+      return -1;
+    }
+  }
+  name = spec;
+
+  int sum = 0;
+  for (unsigned int tag = 1; tag <= 52; tag++) {
+    // card[].value is 11 for aces and 10 for all the faces
+    weight[tag] = w[(card[tag].value == 11) ? 0 : card[tag].value - 1];
+    sum += weight[tag];
+  }
+  balanced = (sum == 0);
+
+  return 0;
+}
+}
@@ -26,6 +26,9 @@
 #include <fstream>
 #include <algorithm>
 #include <map>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
 
 #include <getopt.h>
 #include <unistd.h>
@@ -34,10 +37,20 @@ namespace lbj {
 Configuration::Configuration(int argc, char **argv) {
 
 ///help+usage+desc [-c path_to_conf_file] [options] 
+///help+usage+desc merge [-c path_to_conf_file] [options] raw_report1 raw_report2 ...
+///help+usage+desc eor [-c path_to_conf_file] [options]
+///help+usage+desc counts [-c path_to_conf_file] [options]
+///help+usage+desc indices [-c path_to_conf_file] [options]
 
 ///help+extra+desc If no configuration file is given, a file named `blackjack.conf`
 ///help+extra+desc in the current directory is used, provided it exists.
 ///help+extra+desc See the full documentation for the available options and the default values.
+///help+extra+desc The `merge` subcommand combines the `raw_report` files of several runs (e.g. shards)
+///help+extra+desc into a single report.
+///help+extra+desc The `eor` subcommand computes the effect of removal of each rank off the top of the shoe
+///help+extra+desc and the weights of the linear count that follow from them.
+///help+extra+desc The `counts` subcommand compares several card-counting systems on the same cards.
+///help+extra+desc The `indices` subcommand finds the counts at which index plays change the basic strategy.
   
   const struct option longopts[] = {
 ///op+conf+option `-c<`*path*`>`  or `--conf=`*path*
@@ -138,6 +151,10 @@ Configuration::Configuration(int argc, char **argv) {
     }
   }
 
+  for (int i = optind; i < argc; i++) {
+    arguments.push_back(argv[i]);
+  }
+
   std::ifstream default_file(config_file_path);
   if (default_file.good()) {
     if (readConfigFile(config_file_path, explicit_config_file) != 0) {
@@ -169,16 +186,27 @@ Configuration::Configuration(int argc, char **argv) {
 ///conf+player+details See @sec-players for examples.
 ///conf+player+details  * `internal`: the dealer plays against an internal player already programmed in
 ///conf+player+details Libre Blackjack that bets flat, never takes insurance and follows the basic strategy. 
-///conf+player+details The strategy can be changed by setting the configuration variable `strategy_file`.
+///conf+player+details The strategy can be changed by setting the configuration variable `strategy_file`
+///conf+player+details and the bets by setting `betting_system`.
 ///conf+player+details This player is chosen if `-i` is passed in the command line.
+///conf+player+details  * `counter`: like `internal` but it keeps a card count (see `count_system`), bets according to
+///conf+player+details `bet_ramp` and deviates from the basic strategy according to `deviations`.
 ///conf+player+default If neither the standard input nor output of the executable `blackjack` is re-directed, the default is `tty`.
 ///conf+player+default If at least one of them is re-directed or piped, the default is `stdio`.
 ///conf+player+example player = tty
 ///conf+player+example player = stdio
 ///conf+player+example player = internal
+///conf+player+example player = counter
   if (set(player, {"player"}) == false) {
     // if we are on an interactive terminal we play through tty otherwise stdinout
-    if (isatty(fileno(stdin)) && isatty(fileno(stdout)))  {
+    // (merging does not play, but the internal player tells which strategy was used,
+    // and sweeps, deltas, eors, counts and indices are played only by the internal player)
+    bool subcommand = (arguments.empty() == false &&
+                       (arguments.front() == "merge" || arguments.front() == "eor" ||
+                        arguments.front() == "counts" || arguments.front() == "indices"));
+    if (subcommand || sweep.empty() == false || deltas.empty() == false) {
+      player = "internal";
+    } else if (isatty(fileno(stdin)) && isatty(fileno(stdout)))  {
       player = "tty";
     } else {
       player = "stdio";
@@ -227,12 +255,49 @@ std::string strip_inline_comment(const std::string& line) {
     return line.substr(0, comment_pos);
 }
 
+// comma-separated list of values, where each one can be a start:step:end range
+static int expand_sweep_values(const std::string &list, std::list<std::string> &values) {
+  std::istringstream iss(list);
+  std::string item;
+  while (std::getline(iss, item, ',')) {
+    item = trim(item);
+    if (item.empty()) {
+      return -1;
+    }
+    std::size_t first = item.find(':');
+    std::size_t second = (first != std::string::npos) ? item.find(':', first + 1) : std::string::npos;
+    if (first == std::string::npos) {
+      values.push_back(item);
+    } else if (second != std::string::npos) {
+      char *end[3];
+      double start = std::strtod(item.c_str(), &end[0]);
+      double step = std::strtod(item.c_str() + first + 1, &end[1]);
+      double stop = std::strtod(item.c_str() + second + 1, &end[2]);
+      if (end[0] != item.c_str() + first || end[1] != item.c_str() + second || *end[2] != '\0' ||
+          step <= 0 || stop < start) {
+        return -1;
+      }
+      // a little slack so 0.5:0.1:0.9 does include 0.9
+      long n = static_cast<long>(std::floor((stop - start) / step + 1e-9));
+      for (long i = 0; i <= n; i++) {
+        std::ostringstream value;
+        value << start + i * step;
+        values.push_back(value.str());
+      }
+    } else {
+      return -1;
+    }
+  }
+  return 0;
+}
+
 int Configuration::readConfigFile(std::string file_path, bool mandatory) {
 
   std::ifstream fileStream(file_path);
 
   if (fileStream.is_open()) {
     int line_num = 0; 
+    std::string section;
     std::string line;
     while(getline(fileStream, line)) {
       line_num++;
@@ -241,11 +306,73 @@ int Configuration::readConfigFile(std::string file_path, bool mandatory) {
         continue;
       }
 
+///conf+sweep+usage `[sweep]`
+///conf+sweep+details Every `key = ` $v_1$`, `$v_2$`, ...` line after a line with `[sweep]` is not a single setting
+///conf+sweep+details but an axis of a grid of configurations that are all played by the internal player in the same process.
+///conf+sweep+details Values are separated by commas, so they can have spaces (e.g. `rules = h17 das, s17 ndas`).
+///conf+sweep+details Numerical ranges can be given as `start:step:end`.
+///conf+sweep+details The section extends up to the end of the file.
+///conf+sweep+default No sweep, only one configuration is played.
+///conf+sweep+example [sweep]
+///conf+sweep+example decks = 1, 2, 6, 8
+///conf+sweep+example penetration = 0.5:0.1:0.9
+///conf+sweep+example rules = h17 das, s17 das, h17 ndas, s17 ndas
+///conf+deltas+usage `[deltas]`
+///conf+deltas+details Every `key = value` line after a line with `[deltas]` is a change to the base configuration whose effect
+///conf+deltas+details on the expected value is wanted. Each round is played under the base configuration and under each
+///conf+deltas+details change (one at a time) with the very same cards, so the differences have paired error bars that are much
+///conf+deltas+details smaller than the ones of independent simulations.
+///conf+deltas+details Changes to `rules` are appended to the base `rules`, and the same key can be given more than once.
+///conf+deltas+details Settings about the shoe (i.e. `decks`, `penetration`, `number_of_burnt_cards`, `shuffle_every_hand`,
+///conf+deltas+details `rng_seed` and `hands`) cannot be changed because every rule set plays the cards of the base shoe.
+///conf+deltas+details The section extends up to the end of the file.
+///conf+deltas+default No deltas, only the base configuration is played.
+///conf+deltas+example [deltas]
+///conf+deltas+example rules = s17
+///conf+deltas+example rules = ndas
+///conf+deltas+example rules = do9
+///conf+deltas+example rules = enhc
+///conf+deltas+example blackjack_pays = 1.2
+///conf+deltas+example resplits = 1
+      if (line[0] == '[') {
+        if (line == "[sweep]" || line == "[deltas]") {
+          section = line.substr(1, line.size() - 2);
+          continue;
+        }
+        std::cerr << "error: unknown section " << line << " in " << file_path << ":" << line_num << std::endl;
+        return -1;
+      }
+
       std::size_t delimiter_pos = line.find("=");
       if (delimiter_pos != std::string::npos) {
         std::string name = trim(line.substr(0, delimiter_pos));
         std::string value = trim(line.substr(delimiter_pos + 1));
-        if (!exists(name)) {
+        if (section == "sweep") {
+          std::list<std::string> values;
+          if (expand_sweep_values(value, values) != 0 || values.empty()) {
+            std::cerr << "error: invalid values for sweep axis '" << name << "' in " << file_path << ":" << line_num << std::endl;
+            return -1;
+          }
+          for (auto &axis : sweep) {
+            if (axis.first == name) {
+              std::cerr << "error: sweep axis '" << name << "' given twice in " << file_path << ":" << line_num << std::endl;
+              return -1;
+            }
+          }
+          sweep.push_back(std::make_pair(name, values));
+        } else if (section == "deltas") {
+          // every rule set is dealt the cards of the base shoe, so changing the shoe would change nothing
+          static const char * const shoe_settings[] = {"decks", "n_decks", "penetration", "penetration_sigma", "penetration_dispersion",
+                                                       "number_of_burnt_cards", "n_burnt_cards", "burnt_cards",
+                                                       "shuffle", "shuffle_every_hand", "rng_seed", "seed", "shard", "hands", "n_hands"};
+          for (auto shoe_setting : shoe_settings) {
+            if (name == shoe_setting) {
+              std::cerr << "error: '" << name << "' cannot be changed in [deltas] because every rule set plays the base shoe, in " << file_path << ":" << line_num << std::endl;
+              return -1;
+            }
+          }
+          deltas.push_back(std::make_pair(name, value));
+        } else if (!exists(name)) {
           conf[name] = value;
           used[name] = false;
         }
@@ -343,6 +470,12 @@ bool Configuration::set(double *value, std::list<std::string> key) {
   return false;
 }
 
+void Configuration::put(std::string key, std::string value) {
+  conf[key] = value;
+  used[key] = false;
+  return;
+}
+
 void Configuration::markUsed(std::string key) {
   used[key] = true;
   return;
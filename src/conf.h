@@ -45,6 +45,9 @@ class Configuration {
     bool set(double *, std::list<std::string>);
     bool set(std::string &, std::list<std::string>);
     void markUsed(std::string);
+    bool isUsed(std::string key) { return (used.count(key) != 0 && used[key]); }
+    // set (or override) a key as if it was read from the configuration file
+    void put(std::string, std::string);
 
     int checkUsed(void);
     void show(void);
@@ -55,6 +58,14 @@ class Configuration {
     std::string getDealerName(void) { return dealer; };
     std::string getPlayerName(void) { return player; };
 
+    // whatever is left in the command line after the options (e.g. merge file1 file2)
+    std::list<std::string> arguments;
+
+    // axes of the grid given in the [sweep] section of the configuration file, in order
+    std::list<std::pair<std::string, std::list<std::string>>> sweep;
+    // single-setting changes to the base configuration given in the [deltas] section, in order
+    std::list<std::pair<std::string, std::string>> deltas;
+
     unsigned int max_incorrect_commands = 10;
     unsigned int progress = 0;
     std::string report_file_path;
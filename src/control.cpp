@@ -0,0 +1,229 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - control socket
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <sstream>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "dealer.h"
+#include "control.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace lbj {
+
+Control::Control(std::string p) : path(p) {
+  return;
+}
+
+Control::~Control() {
+  running = false;
+  if (thread.joinable()) {
+    thread.join();
+  }
+  if (fd >= 0) {
+    close(fd);
+    unlink(path.c_str());
+  }
+}
+
+int Control::start(void) {
+
+  struct sockaddr_un address = {};
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "error: control socket path " << path << " is too long" << std::endl;
+    return -1;
+  }
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    std::cerr << "error: cannot create control socket: " << strerror(errno) << std::endl;
+    return -1;
+  }
+
+  // a stale socket from a previous run would make bind fail
+  unlink(path.c_str());
+  if (bind(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 4) != 0) {
+    std::cerr << "error: cannot bind control socket " << path << ": " << strerror(errno) << std::endl;
+    close(fd);
+    fd = -1;
+    return -1;
+  }
+
+  running = true;
+  thread = std::thread(&Control::serve, this);
+  return 0;
+}
+
+bool Control::push(ControlCommand command) {
+  size_t h = head.load(std::memory_order_relaxed);
+  size_t next = (h + 1) % queue.size();
+  if (next == tail.load(std::memory_order_acquire)) {
+    return false;
+  }
+  queue[h] = command;
+  head.store(next, std::memory_order_release);
+  return true;
+}
+
+bool Control::pop(ControlCommand &command) {
+  size_t t = tail.load(std::memory_order_relaxed);
+  if (t == head.load(std::memory_order_acquire)) {
+    return false;
+  }
+  command = queue[t];
+  tail.store((t + 1) % queue.size(), std::memory_order_release);
+  return true;
+}
+
+void Control::publish(size_t n, size_t n_total, double t, double m, double e, int verbosity, bool p) {
+  hands.store(n, std::memory_order_relaxed);
+  hands_total.store(n_total, std::memory_order_relaxed);
+  elapsed.store(t, std::memory_order_relaxed);
+  mean.store(m, std::memory_order_relaxed);
+  error.store(e, std::memory_order_relaxed);
+  report_verbosity.store(verbosity, std::memory_order_relaxed);
+  paused.store(p, std::memory_order_relaxed);
+  return;
+}
+
+///ctl+status+usage `status`
+///ctl+status+details Returns a JSON object with the hands played so far, the total number of hands,
+///ctl+status+details the throughput, the current mean and error, the report verbosity and whether
+///ctl+status+details the simulation is paused. Values are updated every thousand hands or so.
+///ctl+pause+usage `pause`
+///ctl+pause+details Pauses the simulation at the beginning of the next hand.
+///ctl+resume+usage `resume`
+///ctl+resume+details Resumes a paused simulation.
+///ctl+hands+usage `hands` $n$
+///ctl+hands+details Changes the total number of hands to play to $n$.
+///ctl+extend+usage `extend` $n$
+///ctl+extend+details Adds $n$ hands to the total number of hands to play.
+///ctl+verbosity+usage `verbosity` $n$
+///ctl+verbosity+details Changes the report verbosity to $n$.
+///ctl+checkpoint+usage `checkpoint`
+///ctl+checkpoint+details Writes the interim report (and the results cache, if any) as with `SIGUSR1`.
+///ctl+quit+usage `quit`
+///ctl+quit+details Finishes the current hand, writes the final report and exits.
+std::string Control::answer(std::string line) {
+
+  std::istringstream iss(line);
+  std::string token;
+  iss >> token;
+
+  ControlCommand command;
+  if (token == "status") {
+    std::ostringstream json;
+    double t = elapsed.load(std::memory_order_relaxed);
+    size_t n = hands.load(std::memory_order_relaxed);
+    json << "{\"hands\": " << n
+         << ", \"hands_total\": " << hands_total.load(std::memory_order_relaxed)
+         << ", \"hands_per_second\": " << ((t > 0) ? n / t : 0)
+         << ", \"elapsed\": " << t
+         << ", \"mean\": " << mean.load(std::memory_order_relaxed)
+         << ", \"error\": " << error.load(std::memory_order_relaxed)
+         << ", \"report_verbosity\": " << report_verbosity.load(std::memory_order_relaxed)
+         << ", \"paused\": " << (paused.load(std::memory_order_relaxed) ? "true" : "false")
+         << "}";
+    return json.str();
+  } else if (token == "pause") {
+    command.action = ControlAction::Pause;
+  } else if (token == "resume") {
+    command.action = ControlAction::Resume;
+  } else if (token == "hands") {
+    command.action = ControlAction::Hands;
+  } else if (token == "extend") {
+    command.action = ControlAction::Extend;
+  } else if (token == "verbosity") {
+    command.action = ControlAction::Verbosity;
+  } else if (token == "checkpoint") {
+    command.action = ControlAction::Checkpoint;
+  } else if (token == "quit") {
+    command.action = ControlAction::Quit;
+  } else {
+    return "{\"ok\": false, \"error\": \"unknown command\"}";
+  }
+
+  if (command.action == ControlAction::Hands || command.action == ControlAction::Extend || command.action == ControlAction::Verbosity) {
+    double value = 0;
+    if (!(iss >> value) || value < 0) {
+      return "{\"ok\": false, \"error\": \"expected a non-negative number\"}";
+    }
+    command.value = static_cast<long>(value);
+  }
+
+  if (push(command) == false) {
+    return "{\"ok\": false, \"error\": \"queue full\"}";
+  }
+  Dealer::requests.fetch_or(Dealer::RequestCommand);
+
+  return "{\"ok\": true}";
+}
+
+void Control::serve(void) {
+
+  while (running) {
+    // wake up every now and then to see if we have to leave
+    struct pollfd listener = {fd, POLLIN, 0};
+    if (poll(&listener, 1, 200) <= 0) {
+      continue;
+    }
+
+    int client = accept(fd, nullptr, nullptr);
+    if (client < 0) {
+      continue;
+    }
+
+    // do not let a silent client hold the control thread forever
+    struct timeval timeout = {1, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string buffer;
+    char chunk[256];
+    ssize_t n = 0;
+    while (running && (n = recv(client, chunk, sizeof(chunk), 0)) > 0) {
+      buffer.append(chunk, n);
+      std::size_t newline = 0;
+      while ((newline = buffer.find('\n')) != std::string::npos) {
+        std::string response = answer(buffer.substr(0, newline)) + "\n";
+        buffer.erase(0, newline + 1);
+        send(client, response.c_str(), response.size(), MSG_NOSIGNAL);
+      }
+    }
+    // a last command without a newline
+    if (buffer.find_first_not_of(" \t\r") != std::string::npos) {
+      std::string response = answer(buffer) + "\n";
+      send(client, response.c_str(), response.size(), MSG_NOSIGNAL);
+    }
+    close(client);
+  }
+
+  return;
+}
+}
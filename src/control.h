@@ -0,0 +1,92 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - control socket
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <string>
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace lbj {
+
+  enum class ControlAction {
+    None,
+    Pause,
+    Resume,
+    Hands,
+    Extend,
+    Verbosity,
+    Checkpoint,
+    Quit,
+  };
+
+struct ControlCommand {
+  lbj::ControlAction action = lbj::ControlAction::None;
+  long value = 0;
+};
+
+// a side thread serving a unix-domain socket, it talks to the dealer only
+// through atomics and a single-producer single-consumer command queue
+// so the simulation never waits for the socket
+class Control {
+  public:
+    Control(std::string);
+    ~Control();
+    // delete copy and move constructors
+    Control(Control&) = delete;
+    Control(const Control&) = delete;
+    Control(Control &&) = delete;
+    Control(const Control &&) = delete;
+
+    int start(void);
+
+    // called from the simulation thread
+    bool pop(ControlCommand &);
+    void publish(size_t, size_t, double, double, double, int, bool);
+
+  private:
+    void serve(void);
+    std::string answer(std::string);
+    bool push(ControlCommand);
+
+    std::string path;
+    int fd = -1;
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    std::array<ControlCommand, 32> queue;
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+
+    // what the dealer published the last time
+    std::atomic<size_t> hands{0};
+    std::atomic<size_t> hands_total{0};
+    std::atomic<double> elapsed{0};
+    std::atomic<double> mean{0};
+    std::atomic<double> error{0};
+    std::atomic<int> report_verbosity{0};
+    std::atomic<bool> paused{false};
+};
+}
+#endif
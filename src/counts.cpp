@@ -0,0 +1,418 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - card-counting systems evaluated side by side
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <cmath>
+
+#include "dealer.h"
+#include "blackjack.h"
+#include "players/counter.h"
+
+namespace lbj {
+
+// the composition of the unseen cards is given by the aces to the nines, the tens are what is left
+static const int n_ranks = 10;
+static const int n_regressors = n_ranks - 1;
+
+// plain sums for a correlation, the values are of order one so there is no need for anything fancier
+struct Correlation {
+  double n = 0;
+  double sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+
+  inline void add(double x, double y) {
+    n++;
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    syy += y * y;
+    sxy += x * y;
+  }
+
+  double value(void) const {
+    double vx = sxx / n - (sx / n) * (sx / n);
+    double vy = syy / n - (sy / n) * (sy / n);
+    return (n > 1 && vx > 0 && vy > 0) ? (sxy / n - (sx / n) * (sy / n)) / std::sqrt(vx * vy) : 0;
+  }
+};
+
+// the basic strategy player plus the running counts of all the systems, updated with one row
+// of the (card tag) x (system) matrix of weights per card seen
+class Tracker : public Basic {
+  public:
+    Tracker(Configuration &conf, const std::vector<CountSystem> &s, unsigned int decks) : Basic(conf), systems(s), n_decks(decks) {
+      verbose = true;
+      n = systems.size();
+      weight.resize(53 * n);
+      imbalance.resize(n);
+      for (unsigned int tag = 1; tag <= 52; tag++) {
+        for (size_t j = 0; j < n; j++) {
+          weight[tag * n + j] = systems[j].weight[tag];
+          imbalance[j] += systems[j].weight[tag];
+        }
+        rank[tag] = (card[tag].value == 11) ? 0 : card[tag].value - 1;
+      }
+      running.resize(n);
+      round_count.resize(n);
+      round_per_deck.resize(n);
+      count_regressor.resize(n * n_regressors);
+      count_sums.resize(n);
+      ev.resize(n);
+      playing.resize(n);
+      insurance.resize(n);
+      shuffle();
+    }
+
+    void info(lbj::Info msg, int64_t p1, int64_t) override {
+      switch (msg) {
+        case lbj::Info::Shuffle:
+          shuffle();
+        break;
+        case lbj::Info::NewHand:
+          // what each system would have bet on
+          for (size_t j = 0; j < n; j++) {
+            round_count[j] = count(j);
+            round_per_deck[j] = perDeck(j);
+          }
+          composition(round_composition);
+        break;
+        case lbj::Info::CardPlayer:
+        case lbj::Info::CardDealer:
+        case lbj::Info::CardDealerRevealsHole:
+          // the hole card comes as zero until it is revealed
+          if (p1 > 0 && p1 <= 52) {
+            const int *w = &weight[p1 * n];
+            for (size_t j = 0; j < n; j++) {
+              running[j] += w[j];
+            }
+            seen[rank[p1]]++;
+            n_seen++;
+          }
+        break;
+        default:
+        break;
+      }
+      return;
+    }
+
+    int play(void) override {
+      if (actionRequired == PlayerActionRequired::Insurance) {
+        // insurance is a bet on the hole card being a ten
+        double tens = unseen(n_ranks - 1) / static_cast<double>(left());
+        for (size_t j = 0; j < n; j++) {
+          insurance[j].add(perDeck(j), tens);
+        }
+      } else if (actionRequired == PlayerActionRequired::Play && value_player >= 12 && value_player <= 16) {
+        // most of the index plays are stiffs hitting or standing, and what changes with the count
+        // is how likely the next card is to bust them, relative to what it would be off the top
+        // (a proxy for how well the count plays, not the playing efficiency of the literature)
+        int first_bust = 21 - value_player;   // ranks 0 to 9 are worth 1 to 10
+        unsigned int busting = 0;
+        for (int r = first_bust; r < n_ranks; r++) {
+          busting += unseen(r);
+        }
+        double off_the_top = (4.0 * (n_ranks - first_bust) + 12) / 52.0;
+        double bust = busting / static_cast<double>(left()) - off_the_top;
+        for (size_t j = 0; j < n; j++) {
+          playing[j].add(perDeck(j), bust);
+        }
+      }
+      return Basic::play();
+    }
+
+    // the outcome of the round, in units
+    void settle(double y) {
+      hands++;
+      sum_y += y;
+      for (int k = 0; k < n_regressors; k++) {
+        double d = round_composition[k];
+        sum_d[k] += d;
+        sum_dy[k] += d * y;
+        for (int l = 0; l < n_regressors; l++) {
+          sum_dd[k * n_regressors + l] += d * round_composition[l];
+        }
+      }
+      for (size_t j = 0; j < n; j++) {
+        double x = round_per_deck[j];
+        count_sums[j].add(x, y);
+        for (int k = 0; k < n_regressors; k++) {
+          count_regressor[j * n_regressors + k] += x * round_composition[k];
+        }
+        ev[j][static_cast<int>(std::floor(round_count[j]))].add(y);
+      }
+      return;
+    }
+
+    // correlation of each count with the best linear estimate of the outcome of the round given
+    // the composition of the unseen cards, i.e. a least-squares fit of the outcome over the whole run
+    std::vector<double> betting_correlation(void) const;
+
+    std::vector<CountSystem> systems;
+    std::vector<std::map<int, Running>> ev;
+    std::vector<Correlation> playing;
+    std::vector<Correlation> insurance;
+
+  private:
+    void shuffle(void) {
+      for (size_t j = 0; j < n; j++) {
+        running[j] = systems[j].initial;
+      }
+      for (int r = 0; r < n_ranks; r++) {
+        seen[r] = 0;
+      }
+      n_seen = 0;
+    }
+
+    // the true count for balanced systems and the running count for unbalanced ones, as the counter player
+    inline double count(size_t j) const {
+      return (systems[j].balanced) ? 52.0 * running[j] / left() : running[j];
+    }
+
+    // what the correlations use so all the systems are on the same basis: the running count minus
+    // what it would be if the cards seen were a random sample of the shoe, per deck left
+    // (i.e. the true count for balanced systems)
+    inline double perDeck(size_t j) const {
+      return 52.0 * (running[j] - systems[j].initial - imbalance[j] * n_seen / 52.0) / left();
+    }
+
+    inline unsigned int left(void) const {
+      unsigned int l = 52 * n_decks - n_seen;
+      return (l == 0) ? 1 : l;
+    }
+
+    inline unsigned int unseen(int r) const {
+      unsigned int total = ((r == n_ranks - 1) ? 16 : 4) * n_decks;
+      return (total > seen[r]) ? total - seen[r] : 0;
+    }
+
+    // excess of each rank seen over what a random set of as many cards would have, per deck left,
+    // so a balanced count is exactly the weighted sum of these
+    void composition(double *d) const {
+      for (int r = 0; r < n_regressors; r++) {
+        d[r] = 52.0 * (seen[r] - n_seen * 4.0 / 52.0) / left();
+      }
+    }
+
+    size_t n = 0;
+    unsigned int n_decks = 0;
+    std::vector<int> weight;
+    int rank[53] = {0};
+    std::vector<int> running;
+    std::vector<int> imbalance;   // sum of the weights of a whole deck, zero for balanced systems
+    unsigned int seen[n_ranks];
+    unsigned int n_seen = 0;
+
+    std::vector<double> round_count;
+    std::vector<double> round_per_deck;
+    double round_composition[n_regressors] = {0};
+
+    double hands = 0;
+    double sum_y = 0;
+    double sum_d[n_regressors] = {0};
+    double sum_dy[n_regressors] = {0};
+    double sum_dd[n_regressors * n_regressors] = {0};
+    std::vector<double> count_regressor;
+    std::vector<Correlation> count_sums;
+};
+
+std::vector<double> Tracker::betting_correlation(void) const {
+
+  std::vector<double> bc(n, 0.0);
+  if (hands < 2) {
+    return bc;
+  }
+
+  // covariance of the composition and of the composition with the outcome
+  double C[n_regressors * n_regressors];
+  double beta[n_regressors];
+  for (int k = 0; k < n_regressors; k++) {
+    for (int l = 0; l < n_regressors; l++) {
+      C[k * n_regressors + l] = sum_dd[k * n_regressors + l] / hands - sum_d[k] * sum_d[l] / (hands * hands);
+    }
+    beta[k] = sum_dy[k] / hands - sum_d[k] * sum_y / (hands * hands);
+  }
+
+  // C beta = c, Gaussian elimination with partial pivoting (C is symmetric positive definite
+  // unless the shoe is never dealt deep enough to see every rank, then there is nothing to fit)
+  double A[n_regressors * n_regressors];
+  std::copy(C, C + n_regressors * n_regressors, A);
+  double c[n_regressors];
+  std::copy(beta, beta + n_regressors, c);
+  for (int k = 0; k < n_regressors; k++) {
+    int pivot = k;
+    for (int i = k + 1; i < n_regressors; i++) {
+      if (std::abs(A[i * n_regressors + k]) > std::abs(A[pivot * n_regressors + k])) {
+        pivot = i;
+      }
+    }
+    if (std::abs(A[pivot * n_regressors + k]) < 1e-12) {
+      return bc;
+    }
+    for (int l = 0; l < n_regressors; l++) {
+      std::swap(A[k * n_regressors + l], A[pivot * n_regressors + l]);
+    }
+    std::swap(beta[k], beta[pivot]);
+    for (int i = k + 1; i < n_regressors; i++) {
+      double f = A[i * n_regressors + k] / A[k * n_regressors + k];
+      for (int l = k; l < n_regressors; l++) {
+        A[i * n_regressors + l] -= f * A[k * n_regressors + l];
+      }
+      beta[i] -= f * beta[k];
+    }
+  }
+  for (int k = n_regressors - 1; k >= 0; k--) {
+    for (int l = k + 1; l < n_regressors; l++) {
+      beta[k] -= A[k * n_regressors + l] * beta[l];
+    }
+    beta[k] /= A[k * n_regressors + k];
+  }
+
+  // variance of the estimate is beta' C beta = beta' c
+  double variance_estimate = 0;
+  for (int k = 0; k < n_regressors; k++) {
+    variance_estimate += beta[k] * c[k];
+  }
+
+  for (size_t j = 0; j < n; j++) {
+    const Correlation &x = count_sums[j];
+    double variance_count = x.sxx / hands - (x.sx / hands) * (x.sx / hands);
+    double covariance = 0;
+    for (int k = 0; k < n_regressors; k++) {
+      covariance += beta[k] * (count_regressor[j * n_regressors + k] / hands - x.sx * sum_d[k] / (hands * hands));
+    }
+    if (variance_count > 0 && variance_estimate > 0) {
+      bc[j] = covariance / std::sqrt(variance_count * variance_estimate);
+    }
+  }
+
+  return bc;
+}
+
+int count_systems(Configuration &conf) {
+
+  if (reject_per_run_settings(conf, "counts") != 0) {
+    return -1;
+  }
+  if (conf.deltas.empty() == false) {
+    std::cerr << "error: counts cannot have a [deltas] section" << std::endl;
+    return -1;
+  }
+  unsigned int n_decks = 0;
+  conf.set(&n_decks, {"decks", "n_decks"});
+  if (n_decks == 0) {
+    std::cerr << "error: counts needs a non-zero number of decks" << std::endl;
+    return -1;
+  }
+
+///conf+count_systems+usage `count_systems = ` *system*`, ` *system*`, ...`
+///conf+count_systems+details Card-counting systems compared side by side by `blackjack counts`, separated by commas.
+///conf+count_systems+details Each one is either a known system or ten weights as in `count_system`.
+///conf+count_systems+default `hi-lo, ko, hi-opt1, hi-opt2, omega2, zen`
+///conf+count_systems+example count_systems = hi-lo, zen, -1 1 1 1 1 1 0 0 0 -1
+  std::string specs = "hi-lo, ko, hi-opt1, hi-opt2, omega2, zen";
+  conf.set(specs, {"count_systems"});
+  std::vector<CountSystem> systems;
+  std::istringstream iss(specs);
+  std::string spec;
+  while (std::getline(iss, spec, ',')) {
+    spec.erase(0, spec.find_first_not_of(" \t"));
+    spec.erase(spec.find_last_not_of(" \t") + 1);
+    if (spec.empty()) {
+      continue;
+    }
+    systems.emplace_back();
+    if (systems.back().set(spec, n_decks) != 0) {
+      std::cerr << "error: unknown count system '" << spec << "' in count_systems" << std::endl;
+      return -1;
+    }
+  }
+  if (systems.empty()) {
+    std::cerr << "error: count_systems is empty" << std::endl;
+    return -1;
+  }
+
+  double error_standard_deviations = 3.0;
+  conf.set(&error_standard_deviations, {"error_standard_deviations"});
+  std::ofstream file_stream;
+  std::ostream *out = open_report(conf, file_stream);
+  if (out == nullptr) {
+    return -1;
+  }
+
+  Blackjack dealer(conf);
+  Tracker player(conf, systems, n_decks);
+  if (conf.checkUsed() != 0) {
+    return -1;
+  }
+  player.rules = dealer.rules();
+  dealer.setPlayer(&player);
+  dealer.nextAction = DealerAction::StartNewHand;
+
+  Running outcome;
+  while (true) {
+    if (play_round(dealer, player, conf.max_incorrect_commands) != 0) {
+      std::cerr << "error: too many unknown commands" << std::endl;
+      return -1;
+    }
+    if (dealer.finished()) {
+      break;
+    }
+    double y = static_cast<double>(dealer.outcome()) / money_unit;
+    outcome.add(y);
+    player.settle(y);
+  }
+
+  std::vector<double> bc = player.betting_correlation();
+  *out << "---" << std::endl;
+  *out << "rules: " << report_value(reportItem(1, "rules", dealer.rules())) << std::endl;
+  *out << "hands: " << outcome.n << std::endl;
+  *out << "mean: " << outcome.mean << std::endl;
+  *out << "error: " << error_standard_deviations * std::sqrt(outcome.variance() / outcome.n) << std::endl;
+  *out << "systems:" << std::endl;
+  for (size_t j = 0; j < systems.size(); j++) {
+    const CountSystem &system = systems[j];
+    *out << "  - system: " << report_value(reportItem(1, "system", system.name)) << std::endl;
+    *out << "    weights: [";
+    for (unsigned int tag = 1; tag <= 10; tag++) {
+      *out << ((tag > 1) ? ", " : "") << system.weight[tag];
+    }
+    *out << "]" << std::endl;
+    *out << "    balanced: " << ((system.balanced) ? "true" : "false") << std::endl;
+    *out << "    betting_correlation: " << bc[j] << std::endl;
+    *out << "    stiff_bust_correlation: " << player.playing[j].value() << std::endl;
+    *out << "    insurance_correlation: " << player.insurance[j].value() << std::endl;
+    *out << "    ev_by_count:" << std::endl;
+    for (auto &bin : player.ev[j]) {
+      const Running &r = bin.second;
+      *out << "      - count: " << bin.first << std::endl;
+      *out << "        hands: " << r.n << std::endl;
+      *out << "        mean: " << r.mean << std::endl;
+      *out << "        error: " << error_standard_deviations * std::sqrt(r.variance() / r.n) << std::endl;
+    }
+  }
+  *out << "..." << std::endl;
+
+  return 0;
+}
+}
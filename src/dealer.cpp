@@ -19,14 +19,214 @@
  *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
  *------------------- ------------  ----    --------  --     -       -         -
  */
+#include <fstream>
+#include <algorithm>
+#include <thread>
+
+#include <unistd.h>
+
 #include "dealer.h"
 
 namespace lbj {
+
+std::atomic<int> Dealer::requests{0};
+int trace_level = 0;
+
 Dealer::Dealer(Configuration &conf) {
     
   conf.set(&error_standard_deviations, {"error_standard_deviations"});
   conf.set(report_file_path, {"report", "report_file", "report_file_path"});
   conf.set(&report_verbosity, {"report_verbosity", "report_level"});
+
+///conf+trace_level+usage `trace_level = ` $n$
+///conf+trace_level+details If the program was compiled with `--enable-trace`, the dealer writes what is going on
+///conf+trace_level+details into the standard error. A level $n = 1$ traces each new hand, $n = 2$ adds the cards
+///conf+trace_level+details and the player's decisions and $n = 3$ adds every transition of the dealer's state machine.
+///conf+trace_level+details Otherwise the trace is compiled out and this setting does nothing.
+///conf+trace_level+default $0$
+///conf+trace_level+example trace_level = 1
+///conf+trace_level+example trace_level = 3
+  conf.set(&trace_level, {"trace_level", "trace"});
+
+#ifdef ALLOC_COUNT
+  // only blackjack-alloc knows about this one, allocations per hand are counted after this many hands
+  conf.set(&allocs.warmup, {"alloc_warmup"});
+#endif
+
+///conf+timing_sample+usage `timing_sample = ` $n$
+///conf+timing_sample+details Measures the time spent in shuffling, drawing, playing and settling once every $n$ hands
+///conf+timing_sample+details (shuffling is always measured). The estimated totals are written in the report
+///conf+timing_sample+details along with the cpu and wall times when `report_verbosity` is six or more.
+///conf+timing_sample+details The phases are exclusive, e.g. the cards drawn while settling count as drawing and not as settling,
+///conf+timing_sample+details so their times add up to (a bit less than) the cpu time.
+///conf+timing_sample+details This instrumentation can be removed altogether by passing `--disable-timing` to `configure`.
+///conf+timing_sample+default $64$
+///conf+timing_sample+example timing_sample = 1
+///conf+timing_sample+example timing_sample = 1024
+  if (conf.set(&timing.every, {"timing_sample", "timing_every"})) {
+    if (timing.every == 0) {
+      timing.every = 1;
+    }
+    timing.countdown = timing.every;
+  }
+
+///conf+perf_counters+usage `perf_counters = ` $b$
+///conf+perf_counters+details If $b$ is `true`, the cpu cycles, instructions, L1 data cache misses, last-level cache misses
+///conf+perf_counters+details and branch mispredictions spent in the main loop are counted using `perf_event_open` and written
+///conf+perf_counters+details in the report per hand and per card when `report_verbosity` is six or more.
+///conf+perf_counters+details Only user-space events are counted. If the kernel does not allow it (as usual inside containers,
+///conf+perf_counters+details see `/proc/sys/kernel/perf_event_paranoid`) the report says why and the simulation goes on.
+///conf+perf_counters+default `false`
+///conf+perf_counters+example perf_counters = true
+  bool perf_counters = false;
+  conf.set(&perf_counters, {"perf_counters", "perf"});
+  if (perf_counters) {
+    perf.open();
+    perf_requested = true;
+  }
+
+///conf+interim_report+usage `interim_report = ` $\text{path to file}$
+///conf+interim_report+details Sets the path where the dealer writes a report with the results so far when
+///conf+interim_report+details the process receives the `SIGUSR1` signal. The simulation goes on after writing it.
+///conf+interim_report+default `interim.yaml`
+///conf+interim_report+example interim_report = interim.yaml
+///conf+interim_report+example interim_report = stderr
+  conf.set(interim_report_file_path, {"interim_report", "interim_report_file", "interim_report_file_path"});
+
+///conf+raw_report+usage `raw_report = ` $\text{path to file}$
+///conf+raw_report+details If this option is given, the dealer also writes the raw accumulators of the run (number of hands,
+///conf+raw_report+details mean, sum of squared deviations, bankroll and counters) into the given file.
+///conf+raw_report+details Raw reports of different processes, usually each one with a different `shard`,
+///conf+raw_report+details can be combined into a single report with `blackjack merge [options] file1 file2 ...`
+///conf+raw_report+details using the same configuration so the rules in the final report are the right ones.
+///conf+raw_report+default Empty, meaning no raw report
+///conf+raw_report+example raw_report = shard-0.yaml
+  conf.set(raw_report_path, {"raw_report", "raw_report_file", "raw_report_file_path"});
+
+///conf+results_cache+usage `results_cache = ` $\text{path to directory}$
+///conf+results_cache+details If this option is given, the accumulators of the simulation (counters, mean and
+///conf+results_cache+details sum of squared deviations) are stored in a file inside the given directory whose name
+///conf+results_cache+details is a hash of the effective rules, shoe settings and playing strategy.
+///conf+results_cache+details A subsequent run with the same hash merges its results with the stored ones.
+///conf+results_cache+details In this case, `hands` is the total number of hands wanted for that configuration
+///conf+results_cache+details so only the missing hands (if any) are actually played.
+///conf+results_cache+details Only the internal player can be cached.
+///conf+results_cache+details A run that finds another one with the same hash in progress waits until it finishes
+///conf+results_cache+details and then plays only what is still missing.
+///conf+results_cache+default Empty, meaning no cache
+///conf+results_cache+example results_cache = .
+///conf+results_cache+example results_cache = /var/cache/blackjack
+  conf.set(results_cache_path, {"results_cache", "cache"});
+
+///conf+status_file+usage `status_file = ` $\text{path to file}$
+///conf+status_file+details If this option is given, the dealer periodically re-writes a small YAML file
+///conf+status_file+details with the number of hands played so far, the throughput in hands per second,
+///conf+status_file+details the estimated time to finish, the current mean and error and the resident memory.
+///conf+status_file+details The file is written to a temporary location and then renamed, so readers always
+///conf+status_file+details see a complete file.
+///conf+status_file+default Empty, meaning no status file
+///conf+status_file+example status_file = status.yaml
+  conf.set(status_file_path, {"status_file", "status_file_path", "status"});
+
+///conf+status_interval+usage `status_interval = ` $t$
+///conf+status_interval+details Sets the minimum number of seconds $t$ between two consecutive re-writes of `status_file`.
+///conf+status_interval+default $5$
+///conf+status_interval+example status_interval = 1
+///conf+status_interval+example status_interval = 60
+  conf.set(&status_interval, {"status_interval"});
+
+///conf+convergence_file+usage `convergence_file = ` $\text{path to file}$
+///conf+convergence_file+details If this option is given, the dealer appends one line to the file each time
+///conf+convergence_file+details the number of played hands reaches $1$, $2$ or $5$ times a power of ten (starting at one thousand)
+///conf+convergence_file+details with the same data written in `status_file`, so the convergence of the mean can be plotted
+///conf+convergence_file+details after the run.
+///conf+convergence_file+default Empty, meaning no convergence trace
+///conf+convergence_file+example convergence_file = convergence.dat
+  conf.set(convergence_file_path, {"convergence_file", "convergence_trace"});
+
+///conf+control_socket+usage `control_socket = ` $\text{path to socket}$
+///conf+control_socket+details If this option is given, a side thread listens on a unix-domain socket at the given path
+///conf+control_socket+details for one-line commands to query (`status` returns JSON) and steer (`pause`, `resume`,
+///conf+control_socket+details `hands` $n$, `extend` $n$, `verbosity` $n$, `checkpoint`, `quit`) the running simulation.
+///conf+control_socket+details Commands are applied by the dealer at the beginning of the next hand.
+///conf+control_socket+default Empty, meaning no control socket
+///conf+control_socket+example control_socket = /tmp/blackjack.sock
+  std::string control_socket_path;
+  if (conf.set(control_socket_path, {"control_socket", "control"})) {
+    control = std::unique_ptr<Control>(new Control(control_socket_path));
+    if (control->start() != 0) {
+      exit(1);
+    }
+  }
+
+  if (status_file_path.empty() == false || control) {
+    next_status_hand = status_check_hands;
+  }
+  if (convergence_file_path.empty() == false) {
+    std::ofstream file_stream(convergence_file_path);
+    file_stream << "# hands\thands_per_second\telapsed\tmean\terror\trss_kb" << std::endl;
+    next_convergence_hand = 1000;
+    next_status_hand = std::min(next_status_hand, next_convergence_hand);
+  }
     
 }
+
+Dealer::~Dealer() {
+  // releases the lock on the results cache, if any
+  if (results_cache_lock >= 0) {
+    close(results_cache_lock);
+  }
+}
+
+void Dealer::handleRequests(void) {
+  do {
+    int r = requests.exchange(0);
+
+    ControlCommand command;
+    while ((r & RequestCommand) && control->pop(command)) {
+      switch (command.action) {
+        case ControlAction::Pause:
+          paused = true;
+        break;
+        case ControlAction::Resume:
+          paused = false;
+        break;
+        case ControlAction::Hands:
+          n_hands = command.value;
+        break;
+        case ControlAction::Extend:
+          if (n_hands != 0) {
+            n_hands += command.value;
+          }
+        break;
+        case ControlAction::Verbosity:
+          report_verbosity = command.value;
+        break;
+        case ControlAction::Checkpoint:
+          r |= RequestInterimReport;
+        break;
+        case ControlAction::Quit:
+          r |= RequestStop;
+        break;
+        case ControlAction::None:
+        break;
+      }
+    }
+
+    if (r & RequestInterimReport) {
+      writeInterimReport();
+    }
+    if (r & RequestStop) {
+      finished(true);
+      paused = false;
+    }
+
+    if (paused) {
+      writeStatus();
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+  } while (paused);
+
+  return;
+}
 }
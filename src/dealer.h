@@ -23,18 +23,45 @@
 #ifndef BASE_H
 #define BASE_H
 
+#include <cstdint>
+#include <iosfwd>
 #include <string>
 #include <list>
+#include <vector>
 #include <unordered_map>
+#include <map>
 #include <random>
 #include <cmath>
+#include <chrono>
+#include <limits>
+#include <atomic>
+#include <memory>
 
 #include "conf.h"
+#include "control.h"
+#include "timing.h"
+#include "events.h"
+#include "alloc.h"
+#include "perf.h"
 
 namespace lbj {
   void shortversion(void);
   void help(const char *);
   void copyright(void);
+  // play the whole grid of the [sweep] section, see sweep.cpp
+  int sweep(Configuration &);
+  // play the same rounds under the base rules and each change of the [deltas] section, see deltas.cpp
+  int deltas(Configuration &);
+  // blackjack eor, effect of removal of each rank with the [deltas] machinery
+  int effect_of_removal(Configuration &);
+  // blackjack counts, several card-counting systems evaluated side by side on the same shoe, see counts.cpp
+  int count_systems(Configuration &);
+  // blackjack indices, crossover counts of index plays from exploring both actions, see indices.cpp
+  int index_plays(Configuration &);
+  // settings that make each dealer write its own files, which cannot be used with several dealers
+  int reject_per_run_settings(Configuration &, const std::string &);
+  // the stream where the report would have gone (stderr unless report says otherwise), see deltas.cpp
+  std::ostream *open_report(Configuration &, std::ofstream &);
 
   enum class DealerAction {
     None,
@@ -102,6 +129,11 @@ namespace lbj {
     CommandInvalid,
     Bye,
   };
+
+  // money is an integer number of thousandths of a betting unit (bets are whole units)
+  // so 3:2, 6:5 and insurance are exact and sums do not depend on the order of the
+  // additions, info() passes money in these units as well
+  const int64_t money_unit = 1000;
   
   // alphabetically-sorted
   enum class Suit {
@@ -149,9 +181,21 @@ class Card {
 // TODO: class static? which class?
 extern Card card[53];
 
+// a linear count, i.e. what each card adds to the running count
+struct CountSystem {
+  std::string name;
+  int weight[53] = {0};   // by card tag, so counting a card is a single lookup
+  int initial = 0;        // initial running count after shuffling
+  bool balanced = true;   // balanced systems are divided by the decks left (true count)
+
+  // either the name of a known system or the weights of A 2 3 4 5 6 7 8 9 T
+  int set(const std::string &, unsigned int);
+};
+
 class Hand {
   public:
-    std::list<unsigned int> cards;
+    // a vector keeps its capacity after clear() so hands do not allocate once warmed up
+    std::vector<unsigned int> cards;
 
     // inline on purpose
     int value() const {
@@ -193,6 +237,66 @@ class PlayerHand : public Hand {
     bool doubled = false;
 };
 
+struct reportItem {
+  reportItem(int l, std::string k, std::string s) : level(l), key(k), string(s) {};
+  reportItem(int l, std::string k, double v) : level(l), key(k), value(v) {};
+  int level;
+  std::string key;
+  double value;
+  std::string string;
+};
+
+// running mean and sum of squared deviations (Welford)
+struct Running {
+  uint64_t n = 0;
+  double mean = 0;
+  double M2 = 0;
+
+  inline void add(double x) {
+    n++;
+    double delta = x - mean;
+    mean += delta / n;
+    M2 += delta * (x - mean);
+  }
+
+  double variance(void) const {
+    return (n > 1) ? M2 / (n - 1) : 0;
+  }
+};
+
+// outcome of the rounds binned by the count and the depth into the shoe at the time of the bet, see edge_profile
+struct EdgeProfile {
+  int min_count = 0;
+  int n_counts = 0;           // zero means we are not profiling
+  unsigned int n_depths = 0;
+  std::vector<Running> bins;  // by count and then by depth
+  size_t current = 0;         // the bin of the round being played
+
+  bool enabled(void) const {
+    return n_counts != 0;
+  }
+
+  void set(int min, int max, unsigned int depths) {
+    min_count = min;
+    n_counts = max - min + 1;
+    n_depths = depths;
+    bins.assign(n_counts * n_depths, Running());
+  }
+
+  // the ends of the count take whatever is beyond them
+  inline void start(double count, double depth) {
+    int i = static_cast<int>(std::floor(count)) - min_count;
+    i = (i < 0) ? 0 : ((i >= n_counts) ? n_counts - 1 : i);
+    unsigned int j = static_cast<unsigned int>(depth * n_depths);
+    j = (j >= n_depths) ? n_depths - 1 : j;
+    current = i * n_depths + j;
+  }
+
+  inline void settle(double outcome) {
+    bins[current].add(outcome);
+  }
+};
+
 class Player {
   public:
     Player(Configuration &conf);
@@ -204,7 +308,12 @@ class Player {
     Player(const Player &&) = delete;
 
     virtual int play(void) = 0;
-    virtual void info(lbj::Info = lbj::Info::None, int p1 = 0, int p2 = 0) { return; }
+    virtual void info(lbj::Info = lbj::Info::None, int64_t p1 = 0, int64_t p2 = 0) { return; }
+    // canonical description of whatever changes the way the player plays
+    // an empty string means the player cannot be described (i.e. it is external)
+    virtual std::string signature(void) { return ""; }
+    // whatever the player has to add to the dealer's report
+    virtual void report(std::list<reportItem> &) { return; }
     
     lbj::PlayerActionRequired actionRequired = lbj::PlayerActionRequired::None;
     lbj::PlayerActionTaken    actionTaken    = lbj::PlayerActionTaken::None;
@@ -213,6 +322,7 @@ class Player {
     std::string rules;
     
     bool verbose = false;
+    bool new_hand_info = false;   // only Info::NewHand even if not verbose, i.e. to follow the bankroll
     bool flat_bet = false;
     bool no_insurance = false;
     bool always_insure = false;
@@ -225,20 +335,11 @@ class Player {
     unsigned int current_bet = 0;
 };
 
-struct reportItem {
-  reportItem(int l, std::string k, std::string s) : level(l), key(k), string(s) {};
-  reportItem(int l, std::string k, double v) : level(l), key(k), value(v) {};
-  int level;
-  std::string key;
-  double value;
-  std::string string;
-};
-
 class Dealer {
   public:
     Dealer(Configuration &);
     Dealer() = default;
-    virtual ~Dealer() = default;
+    virtual ~Dealer();
     // delete copy and move constructors
     Dealer(Dealer&) = delete;
     Dealer(const Dealer&) = delete;
@@ -251,13 +352,17 @@ class Dealer {
     virtual unsigned int draw(Hand * = nullptr) = 0;
     virtual int process(void) = 0;
     virtual std::string rules(void) { return ""; };
+    // canonical description of the effective settings that change the results
+    virtual std::string signature(void) { return ""; };
+    // use an independent random stream (only if the seed was explicitly given)
+    virtual void reseed(size_t) { return; };
     
     void setPlayer(Player *p) {
       player = p;
     }
     
-    void info(lbj::Info msg, int p1 = 0, int p2 = 0) {
-      if (player->verbose) {
+    void info(lbj::Info msg, int64_t p1 = 0, int64_t p2 = 0) {
+      if (player != nullptr && player->verbose) {
         player->info(msg, p1, p2);
       }
       return;
@@ -270,19 +375,57 @@ class Dealer {
     bool finished(bool d) {
       return (done = d);
     }
+
+    // outcome of the hand just played in money_unit (until the next one starts)
+    int64_t outcome(void) const {
+      return playerStats.currentOutcome;
+    }
     
-    void prepareReport(void);
+    void prepareReport(bool = true);
     int writeReportYAML(void);
+    // the items of the last prepareReport() that are within report_verbosity
+    std::list<reportItem> reportItems(void);
+    int writeInterimReport(void);
+
+    int readResultsCache(void);
+    int writeResultsCache(void);
+
+    // raw accumulators of a (possibly sharded) run and `blackjack merge`
+    int writeRawReport(void);
+    int mergeRawReports(const std::list<std::string> &);
+
+    void writeStatus(bool = false);
     
     lbj::DealerAction nextAction = lbj::DealerAction::None;
 
+    // set asynchronously (i.e. from signal handlers) and polled between hands
+    enum Request {
+      RequestInterimReport = 1,
+      RequestStop          = 2,
+      RequestCommand       = 4,
+    };
+    static std::atomic<int> requests;
+
     // default one million hands
     size_t n_hands = 1000000;
     size_t n_hand = 0;
+
+    // this process plays the slice shard_index out of shard_count (zero means not sharded)
+    unsigned int shard_index = 0;
+    unsigned int shard_count = 0;
+
+    // sampled per-phase timing (the player's phase is measured in the main loop)
+    Timing timing;
+    // counters of what happens inside the state machine (only with --enable-counters)
+    Events events;
+    // steady-state allocations (only in blackjack-alloc)
+    AllocCount allocs;
+    // hardware counters around the main loop (only if perf_counters is true)
+    PerfCounters perf;
     
   protected:
     // TODO: multiple players
-    Player *player;
+    Player *player = nullptr;
 
     // TODO: most of the games will have a single element, but maybe
     // there are games where the dealer has more than one hand
@@ -293,7 +436,8 @@ class Dealer {
     double error_standard_deviations = 3.0;
     // default infinite number of decks (it's faster)
     unsigned int n_decks = 0;
-    unsigned int n_shuffles = 0;
+    size_t n_shuffles = 0;
+    size_t n_cards = 0;
     
     struct {
       std::list<PlayerHand> hands;
@@ -302,48 +446,109 @@ class Dealer {
       unsigned int splits = 0;
 
       // TODO: separate handsDealt from handsPlayed
-      unsigned int n_hands = 0;  // this is different from the dealer's due to splitting
+      uint64_t n_hands = 0;  // this is different from the dealer's due to splitting
     
-      unsigned int handsInsured = 0;
-      unsigned int handsDoubled = 0;
-      unsigned int blackjacksPlayer = 0;
-      unsigned int blackjacksDealer = 0;
+      uint64_t handsInsured = 0;
+      uint64_t handsDoubled = 0;
+      uint64_t blackjacksPlayer = 0;
+      uint64_t blackjacksDealer = 0;
     
-      unsigned int bustsPlayer = 0;
-      unsigned int bustsPlayerAllHands = 0; // this is incremented only if all hands were busted (only for enhc)
-      unsigned int bustsDealer = 0;
+      uint64_t bustsPlayer = 0;
+      uint64_t bustsPlayerAllHands = 0; // this is incremented only if all hands were busted (only for enhc)
+      uint64_t bustsDealer = 0;
         
-      unsigned int wins = 0;
-      unsigned int winsInsured = 0;
-      unsigned int winsDoubled = 0;
-      unsigned int winsBlackjack = 0;
+      uint64_t wins = 0;
+      uint64_t winsInsured = 0;
+      uint64_t winsDoubled = 0;
+      uint64_t winsBlackjack = 0;
         
-      unsigned int pushes = 0;
-      unsigned int losses = 0;
+      uint64_t pushes = 0;
+      uint64_t losses = 0;
       // TODO: blackjack_pushes?
       
-      double bankroll = 0;
-      double worstBankroll = 0;
-      double totalMoneyWaged = 0;
+      // in money_unit
+      int64_t bankroll = 0;
+      int64_t worstBankroll = 0;
+      // in whole betting units
+      uint64_t totalMoneyWaged = 0;
       
       // these variables are used to compute the running mean and variance 
-      double currentOutcome = 0;
+      // (mean_c and M2_c keep the low-order bits that do not fit into mean and M2
+      // so long runs do not drift, see updateMeanAndVariance())
+      int64_t currentOutcome = 0;  // in money_unit
       double mean = 0;
+      double mean_c = 0;
       double M2 = 0;
+      double M2_c = 0;
       double variance = 0;
+
+      // only for this run, i.e. neither cached nor merged (it is here so interim reports restore it)
+      EdgeProfile profile;
     } playerStats;
 
     std::string report_file_path;
+    std::string interim_report_file_path = "interim.yaml";
     int report_verbosity = 5;
     
     void updateMeanAndVariance(void);
+
+    // cheap enough to be called once per hand, the clock is read only every now and then
+    inline void checkStatus(void) {
+      if (n_hand >= next_status_hand) {
+        writeStatus();
+      }
+    }
+
+    // to be called before accumulating the last hand, i.e. at the very same
+    // point where the main loop leaves the dealer when the game is over
+    inline void checkRequests(void) {
+      if (requests.load(std::memory_order_relaxed) != 0) {
+        handleRequests();
+      }
+    }
+    void handleRequests(void);
     
   private:
     bool done = false;
     std::list<reportItem> report;
+
+    // on-disk store of the accumulators of previous runs with the same signature
+    std::string results_cache_path;
+    std::string results_cache_file;
+    std::string results_cache_hash;
+    std::map<std::string, double> cached;
+    size_t n_hands_cached = 0;
+    int results_cache_lock = -1;
+
+    std::list<std::pair<std::string, uint64_t *>> counters(void);
+    std::map<std::string, double> accumulators(void);
+    std::string hash(void);
+    void mergeResultsCache(void);
+
+    std::string raw_report_path;
+    size_t n_merged = 0;
+
+    // live status and convergence trace
+    std::string status_file_path;
+    std::string convergence_file_path;
+    double status_interval = 5;
+    double status_last = 0;
+    size_t status_check_hands = 1024;
+    size_t next_status_hand = std::numeric_limits<size_t>::max();
+    size_t next_convergence_hand = std::numeric_limits<size_t>::max();
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    double cpu_start = Timing::cpu();
+
+    bool perf_requested = false;
+
+    std::unique_ptr<Control> control;
+    bool paused = false;
     
 };
 
+// what goes after "key: " in the report (quoted if it is a string and quote is true)
+std::string report_value(const reportItem &, bool = true);
+
 template <typename ... Args> std::string string_format( const std::string& format, Args ... args);
 template <typename ... Args> std::string string_format2( const std::string& format, Args ... args);
 }
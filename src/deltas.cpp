@@ -0,0 +1,241 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - rule-change deltas with common random numbers
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+
+#include "dealer.h"
+#include "blackjack.h"
+#include "players/basic.h"
+
+namespace lbj {
+
+struct RuleSet {
+  std::string change;
+  std::unique_ptr<Configuration> conf;
+  std::unique_ptr<Blackjack> dealer;
+  std::unique_ptr<Player> player;
+  Running outcome;
+  Running delta;
+};
+
+// play one round, i.e. from a new hand up to the point where the next one would start
+int play_round(Blackjack &dealer, Player &player, unsigned int max_incorrect_commands) {
+  do {
+    dealer.deal();
+    if (player.actionRequired != PlayerActionRequired::None) {
+      unsigned int n_incorrect_commands = 0;
+      do {
+        if (n_incorrect_commands++ > max_incorrect_commands) {
+          return -1;
+        }
+        player.play();
+      } while (dealer.process() <= 0);
+    }
+  } while (dealer.nextAction != DealerAction::StartNewHand && dealer.finished() == false);
+
+  return 0;
+}
+
+// the base plus one rule set for each of conf.deltas, all of them played on the same cards
+static int play_deltas(Configuration &conf, std::vector<RuleSet> &sets) {
+
+  sets.resize(1 + conf.deltas.size());
+  sets[0].change = "base";
+  sets[0].conf.reset(new Configuration(conf));
+  size_t i = 1;
+  for (auto &change : conf.deltas) {
+    sets[i].change = change.first + " = " + change.second;
+    sets[i].conf.reset(new Configuration(conf));
+    if (change.first == "rules" || change.first == "removed_cards") {
+      // these are lists, so the change is appended to the base one
+      sets[i].conf->put(change.first, conf.getString(change.first) + " " + change.second);
+    } else {
+      sets[i].conf->put(change.first, change.second);
+    }
+    i++;
+  }
+
+  CommonCards common;
+  for (auto &set : sets) {
+    set.dealer.reset(new Blackjack(*set.conf));
+    set.player.reset(new Basic(*set.conf));
+    if (set.conf->checkUsed() != 0) {
+      return -1;
+    }
+    set.player->rules = set.dealer->rules();
+    set.dealer->setPlayer(set.player.get());
+    set.dealer->setCommonCards(&common);
+    set.dealer->nextAction = DealerAction::StartNewHand;
+  }
+  // the base draws the cards from its shoe (and shuffles it) for everybody
+  common.source = sets[0].dealer.get();
+
+  while (true) {
+    common.round.clear();
+    for (auto &set : sets) {
+      if (play_round(*set.dealer, *set.player, conf.max_incorrect_commands) != 0) {
+        std::cerr << "error: too many unknown commands with " << set.change << std::endl;
+        return -1;
+      }
+    }
+    if (sets[0].dealer->finished()) {
+      break;
+    }
+
+    double base = static_cast<double>(sets[0].dealer->outcome()) / money_unit;
+    sets[0].outcome.add(base);
+    for (size_t j = 1; j < sets.size(); j++) {
+      double x = static_cast<double>(sets[j].dealer->outcome()) / money_unit;
+      sets[j].outcome.add(x);
+      sets[j].delta.add(x - base);
+    }
+  }
+
+  return 0;
+}
+
+// where the report would have gone
+std::ostream *open_report(Configuration &conf, std::ofstream &file_stream) {
+  std::string report_file_path;
+  conf.set(report_file_path, {"report", "report_file", "report_file_path"});
+  if (report_file_path == "stdout") {
+    return &std::cout;
+  } else if (report_file_path.empty() == false && report_file_path != "stderr") {
+    file_stream.open(report_file_path);
+    if (!file_stream.is_open()) {
+      std::cerr << "error: could not open file " << report_file_path << std::endl;
+      return nullptr;
+    }
+    return &file_stream;
+  }
+  return &std::cerr;
+}
+
+int deltas(Configuration &conf) {
+
+  if (reject_per_run_settings(conf, "deltas") != 0) {
+    return -1;
+  }
+
+  double error_standard_deviations = 3.0;
+  conf.set(&error_standard_deviations, {"error_standard_deviations"});
+  std::ofstream file_stream;
+  std::ostream *out = open_report(conf, file_stream);
+  if (out == nullptr) {
+    return -1;
+  }
+
+  std::vector<RuleSet> sets;
+  if (play_deltas(conf, sets) != 0) {
+    return -1;
+  }
+
+  const Running &base = sets[0].outcome;
+  *out << "---" << std::endl;
+  *out << "rules: " << report_value(reportItem(1, "rules", sets[0].dealer->rules())) << std::endl;
+  *out << "hands: " << base.n << std::endl;
+  *out << "mean: " << base.mean << std::endl;
+  *out << "error: " << error_standard_deviations * std::sqrt(base.variance() / base.n) << std::endl;
+  *out << "deltas:" << std::endl;
+  for (size_t j = 1; j < sets.size(); j++) {
+    const Running &x = sets[j].outcome;
+    const Running &d = sets[j].delta;
+    *out << "  - change: " << report_value(reportItem(1, "change", sets[j].change)) << std::endl;
+    *out << "    rules: " << report_value(reportItem(1, "rules", sets[j].dealer->rules())) << std::endl;
+    *out << "    mean: " << x.mean << std::endl;
+    *out << "    delta: " << d.mean << std::endl;
+    // paired, i.e. the error of the mean of the differences of the very same rounds
+    *out << "    error: " << error_standard_deviations * std::sqrt(d.variance() / d.n) << std::endl;
+    // what two independent simulations with the same number of hands would have given
+    *out << "    unpaired_error: " << error_standard_deviations * std::sqrt((base.variance() + x.variance()) / d.n) << std::endl;
+  }
+  *out << "..." << std::endl;
+
+  return 0;
+}
+
+// effect of removal of each rank off the top of a fresh shoe, i.e. a [deltas] run where each
+// change is removing one more card of a rank, and the linear count that follows from them
+int effect_of_removal(Configuration &conf) {
+
+  if (reject_per_run_settings(conf, "eor") != 0) {
+    return -1;
+  }
+  if (conf.deltas.empty() == false) {
+    std::cerr << "error: eor cannot have a [deltas] section" << std::endl;
+    return -1;
+  }
+  if (conf.getInt("decks") <= 0 && conf.getInt("n_decks") <= 0) {
+    std::cerr << "error: eor needs a non-zero number of decks" << std::endl;
+    return -1;
+  }
+
+  double error_standard_deviations = 3.0;
+  conf.set(&error_standard_deviations, {"error_standard_deviations"});
+  std::ofstream file_stream;
+  std::ostream *out = open_report(conf, file_stream);
+  if (out == nullptr) {
+    return -1;
+  }
+
+  // the ten of clubs stands for every ten-valued card
+  static const char * const ranks[] = {"A", "2", "3", "4", "5", "6", "7", "8", "9", "T"};
+  for (auto rank : ranks) {
+    conf.deltas.push_back(std::make_pair("removed_cards", std::string(rank) + "C"));
+  }
+  // EORs are about the top of the shoe
+  conf.put("shuffle_every_hand", "true");
+
+  std::vector<RuleSet> sets;
+  if (play_deltas(conf, sets) != 0) {
+    return -1;
+  }
+
+  // the best linear count has weights proportional to the EORs
+  double max_eor = 0;
+  for (size_t j = 1; j < sets.size(); j++) {
+    max_eor = std::max(max_eor, std::abs(sets[j].delta.mean));
+  }
+
+  const Running &base = sets[0].outcome;
+  *out << "---" << std::endl;
+  *out << "rules: " << report_value(reportItem(1, "rules", sets[0].dealer->rules())) << std::endl;
+  *out << "hands: " << base.n << std::endl;
+  *out << "mean: " << base.mean << std::endl;
+  *out << "error: " << error_standard_deviations * std::sqrt(base.variance() / base.n) << std::endl;
+  *out << "eor:" << std::endl;
+  for (size_t j = 1; j < sets.size(); j++) {
+    const Running &d = sets[j].delta;
+    *out << "  - rank: " << ranks[j-1] << std::endl;
+    *out << "    eor: " << d.mean << std::endl;
+    *out << "    error: " << error_standard_deviations * std::sqrt(d.variance() / d.n) << std::endl;
+    *out << "    weight: " << ((max_eor > 0) ? d.mean / max_eor : 0) << std::endl;
+  }
+  *out << "..." << std::endl;
+
+  return 0;
+}
+}
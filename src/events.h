@@ -0,0 +1,94 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - event counters and leveled trace
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <cstdint>
+#include <iostream>
+
+namespace lbj {
+
+// these have to follow the order of the enums in dealer.h
+static const char * const dealer_action_names[] = {
+  "none",
+  "start_new_hand",
+  "deal_player_first_card",
+  "check_for_blackjacks",
+  "ask_for_play",
+  "move_on_to_next_hand",
+  "hit_dealer_hand",
+};
+
+static const char * const player_action_names[] = {
+  "none",
+  "quit",
+  "help",
+  "rules",
+  "upcard_value",
+  "bankroll",
+  "hands",
+  "table",
+  "bet",
+  "insure",
+  "dont_insure",
+  "stand",
+  "double",
+  "split",
+  "hit",
+};
+
+// what happens inside the dealer's state machine
+struct Events {
+  static const int max_split_depth = 16;
+
+  uint64_t transitions[sizeof(dealer_action_names)/sizeof(*dealer_action_names)] = {0};
+  uint64_t actions[sizeof(player_action_names)/sizeof(*player_action_names)] = {0};
+  uint64_t arranged_hits = 0;
+  uint64_t arranged_misses = 0;
+  uint64_t splits[max_split_depth+1] = {0};
+  uint64_t dealer_hits = 0;
+  uint64_t rejected_commands = 0;
+};
+
+// how verbose the trace is (only if compiled with --enable-trace)
+//  1. hands
+//  2. cards and decisions
+//  3. every transition
+extern int trace_level;
+}
+
+// configure --enable-counters
+#ifdef COUNTERS
+#define LBJ_COUNT(counter)   ((counter)++)
+#else
+#define LBJ_COUNT(counter)   do { } while (0)
+#endif
+
+// configure --enable-trace
+#ifdef TRACE
+#define LBJ_TRACE(level, message) do { if ((level) <= lbj::trace_level) { std::cerr << message << std::endl; } } while (0)
+#else
+#define LBJ_TRACE(level, message) do { } while (0)
+#endif
+
+#endif
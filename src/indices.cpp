@@ -0,0 +1,390 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - index plays from exploring the alternative actions
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <random>
+#include <cmath>
+#include <cctype>
+
+#include "dealer.h"
+#include "blackjack.h"
+#include "players/counter.h"
+
+namespace lbj {
+
+// a (hand, upcard) decision whose two actions are explored, written as in deviations
+struct Cell {
+  std::string hand;
+  std::string up;
+  int value = 0;
+  int upcard = 0;
+  PlayerActionTaken action[2];
+  char letter[2];
+
+  // the outcome of the rounds and the counts where each action was taken, by integer count
+  struct Bin {
+    Running outcome;
+    Running count;
+  };
+  std::map<int, Bin> bins[2];
+
+  int set(const std::string &);
+};
+
+static PlayerActionTaken action_of(char letter, bool insurance) {
+  switch (letter) {
+    case 'h': return PlayerActionTaken::Hit;
+    case 's': return PlayerActionTaken::Stand;
+    case 'd': return PlayerActionTaken::Double;
+    case 'y': return (insurance) ? PlayerActionTaken::Insure : PlayerActionTaken::Split;
+    case 'n': return (insurance) ? PlayerActionTaken::DontInsure : PlayerActionTaken::None;
+  }
+  return PlayerActionTaken::Quit;
+}
+
+// "hand upcard [action action]", the actions default to what the index plays of such hands usually are about
+int Cell::set(const std::string &spec) {
+  std::istringstream iss(spec);
+  std::string first, second;
+  if (!(iss >> hand >> up)) {
+    return -1;
+  }
+  if (up == "A" || up == "a") {
+    upcard = 11;
+    up = "A";
+  } else if (up == "T" || up == "t" || up == "10") {
+    upcard = 10;
+    up = "T";
+  } else if (up.size() == 1 && up[0] >= '2' && up[0] <= '9') {
+    upcard = up[0] - '0';
+  } else {
+    return -1;
+  }
+
+  char kind = std::tolower(hand[0]);
+  if (hand == "ins") {
+    if (upcard != 11) {
+      return -1;
+    }
+    letter[0] = 'y';
+    letter[1] = 'n';
+  } else if (kind == 'p' && hand.size() == 2) {
+    char c = std::toupper(hand[1]);
+    value = (c == 'A') ? 11 : ((c == 'T') ? 20 : 2 * (c - '0'));
+    letter[0] = 'y';
+    letter[1] = 'n';
+  } else if ((kind == 'h' || kind == 's') && hand.size() >= 2) {
+    value = std::atoi(hand.c_str() + 1);
+    if (kind == 'h') {
+      letter[0] = (value <= 11) ? 'd' : 's';
+      letter[1] = 'h';
+    } else {
+      letter[0] = 'd';
+      letter[1] = (value >= 18) ? 's' : 'h';
+    }
+  } else {
+    return -1;
+  }
+  if (hand != "ins" && (value < 4 || value > 20)) {
+    return -1;
+  }
+
+  if (iss >> first) {
+    if (!(iss >> second) || first.size() != 1 || second.size() != 1 || first == second) {
+      return -1;
+    }
+    letter[0] = std::tolower(first[0]);
+    letter[1] = std::tolower(second[0]);
+  }
+  for (int i = 0; i < 2; i++) {
+    action[i] = action_of(letter[i], hand == "ins");
+    bool pair_action = (letter[i] == 'y' || letter[i] == 'n');
+    if (action[i] == PlayerActionTaken::Quit || pair_action != (kind == 'p' || hand == "ins")) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// the counter player (with a flat bet and its deviations, if any) but at the first cell of interest
+// that comes up in a round it flips a coin to choose which of the two actions to take, the rest of
+// the round is played as usual so the outcome measures that one decision alone
+// (insurance is a side bet whose payoff just adds up, so it is explored on its own)
+class Explorer : public Counter {
+  public:
+    Explorer(Configuration &conf, std::vector<Cell> &c, unsigned int seed) : Counter(conf), cells(c), rng(seed) {
+      for (int value = 0; value < 21; value++) {
+        for (int upcard = 0; upcard < 12; upcard++) {
+          hard_cell[value][upcard] = soft_cell[value][upcard] = pair_cell[value][upcard] = -1;
+        }
+      }
+      for (size_t i = 0; i < cells.size(); i++) {
+        const Cell &cell = cells[i];
+        char kind = std::tolower(cell.hand[0]);
+        if (cell.hand == "ins") {
+          insurance_cell = i;
+        } else {
+          ((kind == 'p') ? pair_cell : ((kind == 'h') ? hard_cell : soft_cell))[cell.value][cell.upcard] = i;
+        }
+      }
+    }
+
+    int play(void) override {
+      if (actionRequired == PlayerActionRequired::Insurance && insurance_cell >= 0) {
+        explore(insurance_cell);
+        return 0;
+      }
+
+      Counter::play();
+      if (actionRequired == PlayerActionRequired::Play && explored == false) {
+        std::size_t value = std::abs(value_player);
+        std::size_t upcard = std::abs(value_dealer);
+        int i = (can_split) ? pair_cell[(value_player == -12) ? 11 : value][upcard] : -1;
+        if (i < 0 && actionTaken != PlayerActionTaken::Split) {
+          i = (value_player < 0) ? soft_cell[value][upcard] : hard_cell[value][upcard];
+        }
+        if (i >= 0 && (can_double || (cells[i].action[0] != PlayerActionTaken::Double && cells[i].action[1] != PlayerActionTaken::Double))) {
+          explore(i);
+          if (actionTaken == PlayerActionTaken::None) {
+            // not splitting means playing it as a regular hand
+            actionTaken = hardOrSoft(value, upcard);
+          }
+        }
+      }
+      return 0;
+    }
+
+    // the outcome of the round, in units, goes to the cells explored in it (if any)
+    void settle(double y) {
+      for (int j = 0; j < n_taken; j++) {
+        Cell::Bin &bin = cells[taken[j].cell].bins[taken[j].action][static_cast<int>(std::floor(taken[j].count))];
+        bin.outcome.add(y);
+        bin.count.add(taken[j].count);
+      }
+      n_taken = 0;
+      explored = false;
+      return;
+    }
+
+    // what the basic strategy does in the cell, i.e. 0 or 1 or -1 if it is neither of the two
+    int basic(const Cell &cell) {
+      PlayerActionTaken action = PlayerActionTaken::DontInsure;
+      char kind = std::tolower(cell.hand[0]);
+      if (kind == 'p') {
+        action = (pair[cell.value][cell.upcard] == PlayerActionTaken::Split) ? PlayerActionTaken::Split : PlayerActionTaken::None;
+      } else if (kind == 'h') {
+        action = hard[cell.value][cell.upcard];
+      } else if (kind == 's') {
+        action = soft[cell.value][cell.upcard];
+      }
+      return (action == cell.action[0]) ? 0 : ((action == cell.action[1]) ? 1 : -1);
+    }
+
+  private:
+    void explore(int i) {
+      int a = rng() & 1;
+      actionTaken = cells[i].action[a];
+      taken[n_taken++] = {i, a, count()};
+      explored = (i != insurance_cell);
+    }
+
+    struct Taken {
+      int cell;
+      int action;
+      double count;
+    };
+
+    std::vector<Cell> &cells;
+    std::mt19937 rng;
+    Taken taken[2];          // insurance and one play decision at most
+    int n_taken = 0;
+    bool explored = false;   // a play decision was explored in this round
+    int hard_cell[21][12];
+    int soft_cell[21][12];
+    int pair_cell[21][12];
+    int insurance_cell = -1;
+};
+
+// weighted least squares of the difference of the two actions against the count,
+// the index is where the line crosses zero
+static bool crossover(const Cell &cell, double &index, double &sigma, double &slope, uint64_t &n) {
+  double S = 0, Sx = 0, Sxx = 0, Sy = 0, Sxy = 0;
+  int n_bins = 0;
+  n = 0;
+  for (auto &bin0 : cell.bins[0]) {
+    auto it = cell.bins[1].find(bin0.first);
+    if (it == cell.bins[1].end()) {
+      continue;
+    }
+    const Cell::Bin &a = bin0.second;
+    const Cell::Bin &b = it->second;
+    n += a.outcome.n + b.outcome.n;
+    // a handful of rounds cannot tell their variance
+    if (a.outcome.n < 30 || b.outcome.n < 30) {
+      continue;
+    }
+    double variance = a.outcome.variance() / a.outcome.n + b.outcome.variance() / b.outcome.n;
+    if (variance <= 0) {
+      continue;
+    }
+    double w = 1 / variance;
+    double x = (a.count.mean * a.count.n + b.count.mean * b.count.n) / (a.count.n + b.count.n);
+    double y = a.outcome.mean - b.outcome.mean;
+    S += w;
+    Sx += w * x;
+    Sxx += w * x * x;
+    Sy += w * y;
+    Sxy += w * x * y;
+    n_bins++;
+  }
+
+  double delta = S * Sxx - Sx * Sx;
+  if (n_bins < 2 || delta <= 0) {
+    return false;
+  }
+  double b = (S * Sxy - Sx * Sy) / delta;
+  double a = (Sxx * Sy - Sx * Sxy) / delta;
+  if (b == 0) {
+    return false;
+  }
+  slope = b;
+  index = -a / b;
+  // first-order propagation of the covariance of a and b
+  sigma = std::sqrt(std::abs(Sxx - 2 * index * Sx + index * index * S) / delta) / std::abs(b);
+  return true;
+}
+
+int index_plays(Configuration &conf) {
+
+  if (reject_per_run_settings(conf, "indices") != 0) {
+    return -1;
+  }
+  if (conf.deltas.empty() == false) {
+    std::cerr << "error: indices cannot have a [deltas] section" << std::endl;
+    return -1;
+  }
+  if (conf.getInt("decks") <= 0 && conf.getInt("n_decks") <= 0) {
+    std::cerr << "error: indices needs a non-zero number of decks" << std::endl;
+    return -1;
+  }
+
+///conf+index_cells+usage `index_cells = ` *hand* *upcard* [*action* *action*]`, ...`
+///conf+index_cells+details Decisions whose index plays `blackjack indices` finds, separated by commas.
+///conf+index_cells+details The *hand* and *upcard* are written as in `deviations`. The two actions default to
+///conf+index_cells+details `s h` for hard 12 and up, `d h` for hard 11 and below, `d s` for soft 18 and up, `d h` for other soft hands
+///conf+index_cells+details and `y n` for pairs and insurance.
+///conf+index_cells+details The first time in a round that one of these decisions comes up, one of the two actions is taken at random
+///conf+index_cells+details and the outcome of the round is binned by action and by count.
+///conf+index_cells+details Any other decision in the round (i.e. hard 16 after hitting hard 10) follows the counter's strategy.
+///conf+index_cells+default The Illustrious 18
+///conf+index_cells+example index_cells = h16 T, h15 T, h12 3
+///conf+index_cells+example index_cells = s18 2 d s, p9 7
+  std::string specs = "ins A, h16 T, h15 T, pT 5, pT 6, h10 T, h12 3, h12 2, h11 A, "
+                      "h9 2, h10 A, h9 7, h16 9, h13 2, h12 4, h12 5, h12 6, h13 3";
+  conf.set(specs, {"index_cells"});
+  std::vector<Cell> cells;
+  std::istringstream iss(specs);
+  std::string spec;
+  while (std::getline(iss, spec, ',')) {
+    if (spec.find_first_not_of(" \t") == std::string::npos) {
+      continue;
+    }
+    cells.emplace_back();
+    if (cells.back().set(spec) != 0) {
+      std::cerr << "error: invalid cell '" << spec << "' in index_cells" << std::endl;
+      return -1;
+    }
+  }
+  if (cells.empty()) {
+    std::cerr << "error: index_cells is empty" << std::endl;
+    return -1;
+  }
+
+  double error_standard_deviations = 3.0;
+  conf.set(&error_standard_deviations, {"error_standard_deviations"});
+  std::ofstream file_stream;
+  std::ostream *out = open_report(conf, file_stream);
+  if (out == nullptr) {
+    return -1;
+  }
+
+  // the coins are reproducible if the cards are
+  unsigned int seed = std::random_device()();
+  if (conf.exists("rng_seed") || conf.exists("seed")) {
+    seed = static_cast<unsigned int>(conf.getInt(conf.exists("rng_seed") ? "rng_seed" : "seed")) + 1;
+  }
+
+  Blackjack dealer(conf);
+  Explorer player(conf, cells, seed);
+  if (conf.checkUsed() != 0) {
+    return -1;
+  }
+  player.rules = dealer.rules();
+  dealer.setPlayer(&player);
+  dealer.nextAction = DealerAction::StartNewHand;
+
+  uint64_t hands = 0;
+  while (true) {
+    if (play_round(dealer, player, conf.max_incorrect_commands) != 0) {
+      std::cerr << "error: too many unknown commands" << std::endl;
+      return -1;
+    }
+    if (dealer.finished()) {
+      break;
+    }
+    player.settle(static_cast<double>(dealer.outcome()) / money_unit);
+    hands++;
+  }
+
+  // plain text that deviations_file can read
+  std::string system = "hi-lo";
+  conf.set(system, {"count_system"});
+  *out << "# index plays for " << system << " with " << dealer.rules() << " after " << hands << " hands" << std::endl;
+  *out << "# hand upcard index action" << std::endl;
+  for (auto &cell : cells) {
+    double index = 0;
+    double sigma = 0;
+    double slope = 0;
+    uint64_t n = 0;
+    if (crossover(cell, index, sigma, slope, n) == false) {
+      *out << "# " << cell.hand << " " << cell.up << " not enough decisions (" << n << ")" << std::endl;
+      continue;
+    }
+
+    // the action that gets better as the count goes up is taken at and above the index,
+    // unless that is what the basic strategy does anyway, then the other one is taken below it
+    int above = (slope > 0) ? 0 : 1;
+    bool below = (player.basic(cell) == above);
+    int action = (below) ? 1 - above : above;
+    *out << cell.hand << " " << cell.up << " " << ((below) ? "<" : "")
+         << std::fixed << std::setprecision(1) << index << " " << cell.letter[action]
+         << "   # ± " << error_standard_deviations * sigma << std::defaultfloat
+         << ", " << n << " decisions" << std::endl;
+  }
+
+  return 0;
+}
+}
@@ -21,6 +21,7 @@
  */
 
 #include <iostream>
+#include <csignal>
 
 #include "conf.h"
 #include "dealer.h"
@@ -29,6 +30,7 @@
 #include "players/tty.h"
 #include "players/stdinout.h"
 #include "players/basic.h"
+#include "players/counter.h"
 
 void progress_bar(size_t n, size_t N, int bar_width) {
   float progress = float(n) / N;
@@ -42,6 +44,27 @@ void progress_bar(size_t n, size_t N, int bar_width) {
   std::cerr.flush();  
 }
 
+// handlers only raise a flag, the dealer takes care of it between hands
+extern "C" void signal_handler(int sig) {
+  lbj::Dealer::requests.fetch_or((sig == SIGUSR1) ? lbj::Dealer::RequestInterimReport : lbj::Dealer::RequestStop);
+}
+
+void install_signal_handlers(bool interactive) {
+  struct sigaction action = {};
+  action.sa_handler = signal_handler;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &action, nullptr);
+
+  // a human at the terminal expects ctrl-c to work right away
+  if (interactive == false) {
+    // a second signal kills the process as usual, in case the player is stuck
+    action.sa_flags = SA_RESTART | SA_RESETHAND;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+  }
+}
+
 int main(int argc, char **argv) {
   
   lbj::Configuration conf(argc, argv);
@@ -57,6 +80,23 @@ int main(int argc, char **argv) {
   if (conf.show_version || conf.show_help) {
     return 0;
   }  
+
+  // a [sweep] section in the configuration file plays a whole grid of configurations
+  // and a [deltas] section plays changes to the base one with common cards
+  if (conf.sweep.empty() == false && conf.deltas.empty() == false) {
+    std::cerr << "error: cannot have both [sweep] and [deltas] sections" << std::endl;
+    return 1;
+  } else if (conf.sweep.empty() == false) {
+    return (lbj::sweep(conf) == 0) ? 0 : 1;
+  } else if (conf.arguments.empty() == false && conf.arguments.front() == "eor") {
+    return (lbj::effect_of_removal(conf) == 0) ? 0 : 1;
+  } else if (conf.arguments.empty() == false && conf.arguments.front() == "counts") {
+    return (lbj::count_systems(conf) == 0) ? 0 : 1;
+  } else if (conf.arguments.empty() == false && conf.arguments.front() == "indices") {
+    return (lbj::index_plays(conf) == 0) ? 0 : 1;
+  } else if (conf.deltas.empty() == false) {
+    return (lbj::deltas(conf) == 0) ? 0 : 1;
+  }
   
   // simple factory pattern
   // for more dealers we might have a registration mechanism
@@ -82,6 +122,11 @@ int main(int argc, char **argv) {
     if (conf.progress != 0) {
       progress_bar_width = 50;
     }
+  } else if (player_name == "counter") {
+    player = new lbj::Counter(conf);
+    if (conf.progress != 0) {
+      progress_bar_width = 50;
+    }
   } else {
     std::cerr << "error: unknown player '" << player_name <<"'" << std::endl;
     return 1;
@@ -97,6 +142,22 @@ int main(int argc, char **argv) {
   // assign player to dealer
   dealer->setPlayer(player);
 
+  // blackjack merge [options] file1 file2 ... does not play, it just reports
+  bool merge = (conf.arguments.empty() == false && conf.arguments.front() == "merge");
+  if (merge) {
+    std::list<std::string> files(std::next(conf.arguments.begin()), conf.arguments.end());
+    if (dealer->mergeRawReports(files) != 0) {
+      return 1;
+    }
+
+  // see if we already have results for this very same configuration
+  } else if (dealer->readResultsCache() != 0) {
+    return 1;
+  }
+
+  // SIGUSR1 writes an interim report, SIGINT and SIGTERM finish the current hand and quit
+  install_signal_handlers(player_name == "tty");
+
   // set up progress bar
   const size_t progress_step =  (progress_bar_width) ? dealer->n_hands / progress_bar_width : 0;
   size_t progress_last = 0;
@@ -107,6 +168,7 @@ int main(int argc, char **argv) {
   // --- let the action begin! -------------------------------------------------
   size_t n_incorrect_commands = 0;
   dealer->nextAction = lbj::DealerAction::StartNewHand;
+  dealer->perf.start();
   while (!dealer->finished()) {
     dealer->deal();
     if (player->actionRequired != lbj::PlayerActionRequired::None) {
@@ -116,7 +178,10 @@ int main(int argc, char **argv) {
           std::cerr << "Too many unknown commands." << std::endl;
           return 2;
         }
-        player->play();
+        {
+          LBJ_TIME_PHASE(dealer->timing, lbj::Phase::Play);
+          player->play();
+        }
       } while (dealer->process() <= 0);
     }
     if (progress_bar_width > 0) {
@@ -126,6 +191,7 @@ int main(int argc, char **argv) {
       }
     }
   }
+  dealer->perf.stop();
   // ---------------------------------------------------------------------------
   
   if (progress_bar_width > 0) {
@@ -137,6 +203,8 @@ int main(int argc, char **argv) {
   
   dealer->prepareReport();
   dealer->writeReportYAML();
+  dealer->writeResultsCache();
+  dealer->writeRawReport();
   
   delete player;
   delete dealer;
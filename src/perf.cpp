@@ -0,0 +1,127 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - hardware performance counters
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "perf.h"
+
+namespace lbj {
+
+PerfCounters::~PerfCounters() {
+  for (auto &counter : counters) {
+    close(counter.fd);
+  }
+}
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+static uint64_t cache_event(uint64_t cache, uint64_t op, uint64_t result) {
+  return cache | (op << 8) | (result << 16);
+}
+
+int PerfCounters::open(void) {
+  struct {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+  } events[] = {
+    {"cycles",          PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions",    PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"l1d_misses",      PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"llc_misses",      PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL,  PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"branch_misses",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  };
+
+  for (const auto &event : events) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event.type;
+    attr.config = event.config;
+    attr.disabled = 1;
+    // user space only, that is what perf_event_paranoid = 2 allows
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0) {
+      // containers usually do not allow this, vms might not have some of the events
+      if (reason.empty()) {
+        reason = std::string(event.name) + ": " + strerror(errno);
+      }
+      continue;
+    }
+    counters.push_back({event.name, fd});
+  }
+
+  return counters.size();
+}
+
+void PerfCounters::start(void) {
+  for (auto &counter : counters) {
+    ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+void PerfCounters::stop(void) {
+  for (auto &counter : counters) {
+    ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+}
+
+double PerfCounters::value(const Counter &counter) {
+  uint64_t data[3] = {0, 0, 0};
+  if (read(counter.fd, data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+    return 0;
+  }
+  return static_cast<double>(data[0]) * data[1] / data[2];
+}
+
+#else
+
+int PerfCounters::open(void) {
+  reason = "perf_event_open is not available on this platform";
+  return 0;
+}
+
+void PerfCounters::start(void) {
+  return;
+}
+
+void PerfCounters::stop(void) {
+  return;
+}
+
+double PerfCounters::value(const Counter &) {
+  return 0;
+}
+#endif
+}
@@ -0,0 +1,61 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - hardware performance counters
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lbj {
+
+// cycles, instructions, cache and branch misses of the main loop through perf_event_open
+// (only on linux and only if the kernel lets us, otherwise available() is false)
+class PerfCounters {
+  public:
+    PerfCounters() = default;
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // returns the number of counters that could be opened
+    int open(void);
+    void start(void);
+    void stop(void);
+
+    bool available(void) { return counters.empty() == false; }
+    // why there are no counters
+    std::string reason;
+
+    struct Counter {
+      std::string name;
+      int fd;
+    };
+    std::vector<Counter> counters;
+
+    // value scaled by the fraction of time the counter was actually counting (they can be multiplexed)
+    double value(const Counter &);
+};
+}
+
+#endif
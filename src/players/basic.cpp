@@ -26,10 +26,25 @@
 #include "../conf.h"
 #include "../blackjack.h"
 #include "basic.h"
+#include "../probes.h"
 
 namespace lbj {
 
-Basic::Basic(Configuration &conf) : Player(conf) {
+Basic::Basic(Configuration &conf) : Player(conf), betting(conf) {
+
+  if (betting.active()) {
+    if (flat_bet) {
+      std::cerr << "error: betting_system, base_bet, minimum_bet and session_bankroll need flat_bet = false" << std::endl;
+      exit(1);
+    }
+    if (always_insure && betting.limited()) {
+      // the dealer takes the insurance without asking so the player cannot keep it within the bankroll
+      std::cerr << "error: always_insure cannot be used with session_bankroll" << std::endl;
+      exit(1);
+    }
+    // the progression needs the outcome of each round (but not the cards)
+    new_hand_info = true;
+  }
 
   for (int value = 0; value < 21; value++) {
     for (int upcard = 0; upcard < 12; upcard++) {
@@ -213,6 +228,37 @@ Basic::Basic(Configuration &conf) : Player(conf) {
   return;
 }
 
+// the effective strategy, no matter if it came from the defaults or from a file
+std::string Basic::signature(void) {
+  std::ostringstream oss;
+  oss << "player = internal" << std::endl;
+  oss << "flat_bet = " << flat_bet << std::endl;
+  oss << "no_insurance = " << no_insurance << std::endl;
+  oss << "always_insure = " << always_insure << std::endl;
+  if (betting.active()) {
+    oss << betting.signature();
+  }
+
+  auto action_char = [](PlayerActionTaken action) {
+    switch (action) {
+      case PlayerActionTaken::Hit:    return 'h';
+      case PlayerActionTaken::Stand:  return 's';
+      case PlayerActionTaken::Double: return 'd';
+      case PlayerActionTaken::Split:  return 'y';
+      default:                        return '-';
+    }
+  };
+  
+  for (int value = 0; value < 21; value++) {
+    oss << value << " ";
+    for (int upcard = 0; upcard < 12; upcard++) {
+      oss << action_char(hard[value][upcard]) << action_char(soft[value][upcard]) << action_char(pair[value][upcard]);
+    }
+    oss << std::endl;
+  }
+  return oss.str();
+}
+
 int Basic::play() {
 
   std::size_t value;
@@ -220,7 +266,7 @@ int Basic::play() {
   
   switch (actionRequired) {
     case PlayerActionRequired::Bet:
-      current_bet = 1;
+      current_bet = betting.bet();
       actionTaken = PlayerActionTaken::Bet;
     break;
 
@@ -230,40 +276,14 @@ int Basic::play() {
     
     case PlayerActionRequired::Play:
 
-#ifdef BJDEBUG
-      std::cout << "player " << value_player << " dealer " << value_dealer << std::endl;
-#endif      
+      LBJ_TRACE(2, "player " << value_player << " dealer " << value_dealer);
       value = std::abs(value_player);
       upcard = std::abs(value_dealer);
       
-      // first, we see if we can and shold split
-      if (can_split &&
-           ((value_player == -12 &&    pair[11][upcard] == PlayerActionTaken::Split) ||
-                                   pair[value][upcard] == PlayerActionTaken::Split)) {
-          actionTaken = PlayerActionTaken::Split;
-
-      } else {
+      actionTaken = affordable(basicAction(value, upcard), value, upcard);
       
-        actionTaken = (value_player < 0) ? soft[value][upcard] : hard[value][upcard];
-        
-        if (can_double == false) {
-          if (actionTaken == PlayerActionTaken::Double) {
-            actionTaken = PlayerActionTaken::Hit;
-          }
-        }
-      }
-      
-#ifdef BJDEBUG
-      if (actionTaken == PlayerActionTaken::Hit) {
-        std::cout << "hit" << std::endl;
-      } else if (actionTaken == PlayerActionTaken::Stand) {
-        std::cout << "stand" << std::endl;
-      } else if (actionTaken == PlayerActionTaken::Split) {
-        std::cout << "split" << std::endl;
-      } else {
-        std::cout << "none" << std::endl;
-      }
-#endif
+      LBJ_PROBE3(basic_decision, static_cast<int>(actionTaken), value_player, value_dealer);
+      LBJ_TRACE(2, player_action_names[static_cast<int>(actionTaken)]);
       
       
     break;  
@@ -275,4 +295,18 @@ int Basic::play() {
   
   return 0;
 }
+
+void Basic::info(lbj::Info msg, int64_t, int64_t p2) {
+  if (msg == lbj::Info::NewHand) {
+    betting.newRound(p2);
+  }
+  return;
+}
+
+void Basic::report(std::list<reportItem> &report) {
+  if (betting.active()) {
+    betting.report(report);
+  }
+  return;
+}
 }
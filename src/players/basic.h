@@ -23,6 +23,7 @@
 #ifndef INTERNAL_H
 #define INTERNAL_H
 #include "../blackjack.h"
+#include "betting.h"
 
 namespace lbj {
 
@@ -32,9 +33,47 @@ class Basic : public Player {
     ~Basic() { };
     
     int play(void) override;
+    void info(lbj::Info = lbj::Info::None, int64_t p1 = 0, int64_t p2 = 0) override;
+    std::string signature(void) override;
+    void report(std::list<reportItem> &) override;
 
-  private:
-    
+    // the bets depend on what happened in previous rounds (and sessions), so it cannot be reused
+    inline bool stateful(void) const {
+      return betting.active();
+    }
+
+  protected:
+    // what the tables say, splitting included
+    inline PlayerActionTaken basicAction(std::size_t value, std::size_t upcard) {
+      if (can_split && ((value_player == -12 && pair[11][upcard] == PlayerActionTaken::Split) || pair[value][upcard] == PlayerActionTaken::Split)) {
+        return PlayerActionTaken::Split;
+      }
+      return hardOrSoft(value, upcard);
+    }
+
+    // the action itself if what is left of the session bankroll covers the extra stake it needs
+    // (which is then taken), otherwise the closest one that does not need any money
+    inline PlayerActionTaken affordable(PlayerActionTaken action, std::size_t value, std::size_t upcard) {
+      if (action == PlayerActionTaken::Split || action == PlayerActionTaken::Double) {
+        if (betting.take(money_unit * current_bet) == false) {
+          action = (action == PlayerActionTaken::Split) ? hardOrSoft(value, upcard) : PlayerActionTaken::Hit;
+          if (action == PlayerActionTaken::Double && betting.take(money_unit * current_bet) == false) {
+            action = PlayerActionTaken::Hit;
+          }
+        }
+      } else if (action == PlayerActionTaken::Insure && betting.take(money_unit / 2 * current_bet) == false) {
+        action = PlayerActionTaken::DontInsure;
+      }
+      return action;
+    }
+
+    // what the tables say for a hand that is not going to be split
+    inline PlayerActionTaken hardOrSoft(std::size_t value, std::size_t upcard) {
+      PlayerActionTaken action = (value_player < 0) ? soft[value][upcard] : hard[value][upcard];
+      return (action == PlayerActionTaken::Double && can_double == false) ? PlayerActionTaken::Hit : action;
+    }
+
+    BetSystem betting;
     std::string strategy_file_path{"bs.txt"};
     lbj::PlayerActionTaken pair[21][12];
     lbj::PlayerActionTaken soft[21][12];
@@ -0,0 +1,318 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - bet sizing for internal players
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
+#include "../conf.h"
+#include "betting.h"
+
+namespace lbj {
+
+// no table takes bets this large, it just keeps a runaway progression within an unsigned int
+static const double largest_bet = 1e9;
+
+BetSystem::BetSystem(Configuration &conf) {
+
+///conf+betting_system+usage `betting_system = ` { `flat` | `martingale` | `paroli` | `fibonacci` | `dalembert` | `kelly` }
+///conf+betting_system+details How the internal players (`internal` and `counter`) size their bets when `flat_bet` is false.
+///conf+betting_system+details @
+///conf+betting_system+details | System       | After a loss           | After a win                                 |
+///conf+betting_system+details |:-------------|:-----------------------|:--------------------------------------------|
+///conf+betting_system+details | `flat`       | same bet               | same bet                                    |
+///conf+betting_system+details | `martingale` | doubles the bet        | back to the base bet                        |
+///conf+betting_system+details | `paroli`     | back to the base bet   | doubles the bet, up to `paroli_wins` times  |
+///conf+betting_system+details | `fibonacci`  | next Fibonacci number  | two Fibonacci numbers back                  |
+///conf+betting_system+details | `dalembert`  | one more base bet      | one base bet less                           |
+///conf+betting_system+details @
+///conf+betting_system+details Pushes leave the progression as it is.
+///conf+betting_system+details With `kelly` the bet is `kelly_fraction` times the bankroll times the edge over the variance,
+///conf+betting_system+details where the edge is `kelly_edge` plus `kelly_edge_per_count` times the count of the `counter` player.
+///conf+betting_system+details When the edge is not positive it bets the minimum.
+///conf+betting_system+details Bets are never less than `minimum_bet`, more than `maximum_bet` (if not zero)
+///conf+betting_system+details nor more than what is left of `session_bankroll` (if not zero).
+///conf+betting_system+details When the next bet of a progression is over `maximum_bet` the progression is lost and starts over from the base bet.
+///conf+betting_system+default `flat`
+///conf+betting_system+example betting_system = martingale
+///conf+betting_system+example betting_system = kelly
+  conf.set(name, {"betting_system", "bet_system"});
+  if (name == "flat") {
+    system = System::Flat;
+  } else if (name == "martingale") {
+    system = System::Martingale;
+  } else if (name == "paroli" || name == "reverse-martingale" || name == "reverse_martingale") {
+    name = "paroli";
+    system = System::Paroli;
+  } else if (name == "fibonacci") {
+    system = System::Fibonacci;
+  } else if (name == "dalembert" || name == "d'alembert") {
+    name = "dalembert";
+    system = System::DAlembert;
+  } else if (name == "kelly") {
+    system = System::Kelly;
+  } else {
+    std::cerr << "error: unknown betting_system '" << name << "'" << std::endl;
+    exit(1);
+  }
+
+///conf+base_bet+usage `base_bet = ` $n$
+///conf+base_bet+details Units the internal players bet at the start of a progression (see `betting_system`).
+///conf+base_bet+details The `counter` player multiplies it by the bet in its `bet_ramp`.
+///conf+base_bet+default $1$
+///conf+base_bet+example base_bet = 5
+  conf.set(&base_bet, {"base_bet"});
+  conf.set(&min_bet, {"minimum_bet", "min_bet", "minbet"});
+  conf.set(&max_bet, {"maximum_bet", "max_bet", "maxbet"});
+  if (base_bet == 0) {
+    std::cerr << "error: base_bet has to be positive" << std::endl;
+    exit(1);
+  }
+  if (min_bet == 0) {
+    min_bet = 1;
+  }
+  if (max_bet != 0 && max_bet < min_bet) {
+    std::cerr << "error: maximum_bet is less than minimum_bet" << std::endl;
+    exit(1);
+  }
+
+///conf+paroli_wins+usage `paroli_wins = ` $n$
+///conf+paroli_wins+details Number of wins in a row after which the `paroli` progression goes back to the base bet.
+///conf+paroli_wins+default $3$
+///conf+paroli_wins+example paroli_wins = 2
+  conf.set(&paroli_wins, {"paroli_wins"});
+  if (paroli_wins == 0) {
+    paroli_wins = 1;
+  }
+
+///conf+kelly_fraction+usage `kelly_fraction = ` $f$
+///conf+kelly_fraction+details Fraction of the full Kelly bet the `kelly` betting system places, e.g. $0.5$ for half Kelly.
+///conf+kelly_fraction+default $1$
+///conf+kelly_fraction+example kelly_fraction = 0.5
+  conf.set(&kelly_fraction, {"kelly_fraction"});
+///conf+kelly_edge+usage `kelly_edge = ` $e$
+///conf+kelly_edge+details Edge of the player at a zero count assumed by the `kelly` betting system.
+///conf+kelly_edge+default $-0.005$
+///conf+kelly_edge+example kelly_edge = -0.004
+  conf.set(&kelly_edge, {"kelly_edge"});
+///conf+kelly_edge_per_count+usage `kelly_edge_per_count = ` $e$
+///conf+kelly_edge_per_count+details Edge each point of the count is worth for the `kelly` betting system.
+///conf+kelly_edge_per_count+default $0.005$
+///conf+kelly_edge_per_count+example kelly_edge_per_count = 0.0045
+  conf.set(&kelly_edge_per_count, {"kelly_edge_per_count"});
+///conf+kelly_variance+usage `kelly_variance = ` $\sigma^2$
+///conf+kelly_variance+details Variance of a round assumed by the `kelly` betting system.
+///conf+kelly_variance+default $1.3$
+///conf+kelly_variance+example kelly_variance = 1.33
+  conf.set(&kelly_variance, {"kelly_variance"});
+  if (kelly_variance <= 0) {
+    std::cerr << "error: kelly_variance has to be positive" << std::endl;
+    exit(1);
+  }
+
+///conf+session_bankroll+usage `session_bankroll = ` $n$
+///conf+session_bankroll+details Units an internal player brings to each session.
+///conf+session_bankroll+details When what is left cannot cover `minimum_bet` the player is ruined and starts a new session.
+///conf+session_bankroll+details The player does not double, split nor insure unless what is left covers the extra stake.
+///conf+session_bankroll+details The report then has the number of sessions and the risk of ruin.
+///conf+session_bankroll+details It cannot be less than `minimum_bet`.
+///conf+session_bankroll+details Zero means an unlimited bankroll, which `kelly` cannot work with.
+///conf+session_bankroll+default $0$
+///conf+session_bankroll+example session_bankroll = 200
+  conf.set(&session_bankroll, {"session_bankroll"});
+  if (system == System::Kelly && session_bankroll == 0) {
+    std::cerr << "error: betting_system = kelly needs a session_bankroll" << std::endl;
+    exit(1);
+  }
+  if (session_bankroll != 0 && session_bankroll < min_bet) {
+    std::cerr << "error: session_bankroll is less than minimum_bet" << std::endl;
+    exit(1);
+  }
+///conf+session_goal+usage `session_goal = ` $n$
+///conf+session_goal+details Units won after which an internal player ends the session and starts a new one.
+///conf+session_goal+details Zero means there is no goal.
+///conf+session_goal+default $0$
+///conf+session_goal+example session_goal = 50
+  conf.set(&session_goal, {"session_goal"});
+///conf+session_hands+usage `session_hands = ` $n$
+///conf+session_hands+details Rounds after which an internal player ends the session and starts a new one.
+///conf+session_hands+details Zero means sessions only end by ruin or by reaching the goal.
+///conf+session_hands+default $0$
+///conf+session_hands+example session_hands = 1000
+  conf.set(&session_hands, {"session_hands"});
+
+  bankroll = static_cast<int64_t>(session_bankroll) * money_unit;
+  lowest_bankroll = bankroll;
+  return;
+}
+
+void BetSystem::newSession(void) {
+  sessions++;
+  step = 0;
+  session_round = 0;
+  bankroll = static_cast<int64_t>(session_bankroll) * money_unit;
+  return;
+}
+
+void BetSystem::newRound(int64_t dealer_bankroll) {
+
+  int64_t outcome = dealer_bankroll - last_dealer_bankroll;
+  last_dealer_bankroll = dealer_bankroll;
+  at_stake = 0;
+  if (first_round) {
+    first_round = false;
+    return;
+  }
+  bankroll += outcome;
+  lowest_bankroll = std::min(lowest_bankroll, bankroll);
+  session_round++;
+
+  switch (system) {
+    case System::Flat:
+    case System::Kelly:
+    break;
+    case System::Martingale:
+      step = (outcome < 0) ? step + 1 : ((outcome > 0) ? 0 : step);
+    break;
+    case System::Paroli:
+      if (outcome > 0) {
+        step = (step + 1 < paroli_wins) ? step + 1 : 0;
+      } else if (outcome < 0) {
+        step = 0;
+      }
+    break;
+    case System::Fibonacci:
+      step = (outcome < 0) ? step + 1 : ((outcome > 0) ? ((step > 2) ? step - 2 : 0) : step);
+    break;
+    case System::DAlembert:
+      step = (outcome < 0) ? step + 1 : ((outcome > 0 && step > 0) ? step - 1 : step);
+    break;
+  }
+
+  if ((session_goal != 0 && bankroll >= static_cast<int64_t>(session_bankroll + session_goal) * money_unit) ||
+      (session_hands != 0 && session_round >= session_hands)) {
+    newSession();
+  }
+
+  return;
+}
+
+// what the system asks for, before the table limits and the bankroll
+double BetSystem::progression(unsigned int multiplier, double count) const {
+
+  double units = static_cast<double>(base_bet) * multiplier;
+  switch (system) {
+    case System::Flat:
+    break;
+    case System::Martingale:
+    case System::Paroli:
+      units = std::ldexp(units, static_cast<int>(std::min(step, 64U)));
+    break;
+    case System::Fibonacci:
+      {
+        double a = 1;
+        double b = 1;
+        for (unsigned int i = 1; i < step && b < largest_bet; i++) {
+          double c = a + b;
+          a = b;
+          b = c;
+        }
+        units *= b;
+      }
+    break;
+    case System::DAlembert:
+      units *= 1 + step;
+    break;
+    case System::Kelly:
+      {
+        double edge = kelly_edge + kelly_edge_per_count * count;
+        units = (edge > 0) ? std::floor(kelly_fraction * edge / kelly_variance * bankroll / money_unit) : 0;
+      }
+    break;
+  }
+
+  return units;
+}
+
+unsigned int BetSystem::bet(unsigned int multiplier, double count) {
+
+  // not even the table minimum is left
+  if (session_bankroll != 0 && bankroll < static_cast<int64_t>(min_bet) * money_unit) {
+    ruined_sessions++;
+    newSession();
+  }
+
+  double units = progression(multiplier, count);
+  if (max_bet != 0 && units > max_bet && step != 0) {
+    // the table does not take the next bet of the progression, so it is lost and starts over
+    dropped_progressions++;
+    step = 0;
+    units = progression(multiplier, count);
+  }
+  longest_progression = std::max(longest_progression, step);
+
+  double wanted = std::min(units, largest_bet);
+  units = std::max(wanted, static_cast<double>(min_bet));
+  if (max_bet != 0) {
+    units = std::min(units, static_cast<double>(max_bet));
+  }
+  if (session_bankroll != 0) {
+    units = std::min(units, static_cast<double>(bankroll / money_unit));
+  }
+  if (units < wanted) {
+    capped_bets++;
+  }
+  at_stake = static_cast<int64_t>(units) * money_unit;
+
+  return static_cast<unsigned int>(units);
+}
+
+std::string BetSystem::signature(void) {
+  std::ostringstream oss;
+  oss << "betting_system = " << name << std::endl;
+  oss << "base_bet = " << base_bet << std::endl;
+  oss << "minimum_bet = " << min_bet << std::endl;
+  oss << "maximum_bet = " << max_bet << std::endl;
+  if (system == System::Paroli) {
+    oss << "paroli_wins = " << paroli_wins << std::endl;
+  } else if (system == System::Kelly) {
+    oss << "kelly = " << kelly_fraction << " " << kelly_edge << " " << kelly_edge_per_count << " " << kelly_variance << std::endl;
+  }
+  oss << "session = " << session_bankroll << " " << session_goal << " " << session_hands << std::endl;
+  return oss.str();
+}
+
+void BetSystem::report(std::list<reportItem> &report) {
+  report.push_back(reportItem(3, "betting_system", name));
+  report.push_back(reportItem(3, "capped_bets", static_cast<double>(capped_bets)));
+  report.push_back(reportItem(3, "longest_progression", static_cast<double>(longest_progression)));
+  report.push_back(reportItem(3, "dropped_progressions", static_cast<double>(dropped_progressions)));
+  if (session_bankroll != 0 || session_goal != 0 || session_hands != 0) {
+    // the session being played when the dealer stopped does not count
+    report.push_back(reportItem(3, "sessions", static_cast<double>(sessions)));
+    report.push_back(reportItem(3, "ruined_sessions", static_cast<double>(ruined_sessions)));
+    report.push_back(reportItem(3, "lowest_bankroll", static_cast<double>(lowest_bankroll) / money_unit));
+    report.push_back(reportItem(3, "risk_of_ruin", (sessions != 0) ? static_cast<double>(ruined_sessions) / sessions : 0.0));
+  }
+  return;
+}
+}
@@ -0,0 +1,108 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - bet sizing for internal players
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+
+#ifndef BETTING_H
+#define BETTING_H
+#include <string>
+#include <list>
+
+#include "../dealer.h"
+
+namespace lbj {
+
+// how much an internal player bets, the state of the progression goes from one round to the next
+class BetSystem {
+  public:
+    BetSystem(Configuration &);
+
+    // anything other than a flat bet of one unit with an unlimited bankroll
+    inline bool active(void) const {
+      return system != System::Flat || base_bet != 1 || min_bet > 1 || session_bankroll != 0;
+    }
+
+    // sessions have a limited bankroll
+    inline bool limited(void) const {
+      return session_bankroll != 0;
+    }
+
+    // the dealer's bankroll at the beginning of a round, the difference with the previous one is the previous outcome
+    void newRound(int64_t dealer_bankroll);
+    // units to bet, the multiplier comes from the player (i.e. a ramp) and the count is used by kelly
+    unsigned int bet(unsigned int multiplier = 1, double count = 0);
+    // adds money (in thousandths of a unit) to what is at stake in the current round if the bankroll covers it
+    inline bool take(int64_t money) {
+      if (session_bankroll != 0 && bankroll - at_stake < money) {
+        return false;
+      }
+      at_stake += money;
+      return true;
+    }
+
+    std::string signature(void);
+    void report(std::list<reportItem> &);
+
+  private:
+    enum class System {
+      Flat,
+      Martingale,
+      Paroli,
+      Fibonacci,
+      DAlembert,
+      Kelly,
+    };
+    void newSession(void);
+    double progression(unsigned int, double) const;
+
+    System system = System::Flat;
+    std::string name{"flat"};
+    unsigned int base_bet = 1;
+    unsigned int min_bet = 1;
+    unsigned int max_bet = 0;
+    unsigned int paroli_wins = 3;
+    double kelly_fraction = 1;
+    double kelly_edge = -0.005;
+    double kelly_edge_per_count = 0.005;
+    double kelly_variance = 1.3;
+
+    // sessions end when the bankroll cannot cover the minimum bet (ruin), after reaching the goal or after a number of rounds
+    unsigned int session_bankroll = 0;
+    unsigned int session_goal = 0;
+    unsigned int session_hands = 0;
+
+    // state
+    unsigned int step = 0;        // position in the progression, zero means the base bet
+    int64_t bankroll = 0;         // what is left of the session bankroll, in thousandths of a unit
+    int64_t at_stake = 0;         // what the player has put on the table in the current round
+    int64_t last_dealer_bankroll = 0;
+    unsigned int session_round = 0;
+    bool first_round = true;
+
+    // stats
+    uint64_t sessions = 0;
+    uint64_t ruined_sessions = 0;
+    uint64_t capped_bets = 0;
+    uint64_t dropped_progressions = 0;
+    unsigned int longest_progression = 0;
+    int64_t lowest_bankroll = 0;
+};
+}
+#endif
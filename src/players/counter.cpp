@@ -0,0 +1,321 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - card-counting internal player
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cctype>
+#include <algorithm>
+
+#include "../conf.h"
+#include "../blackjack.h"
+#include "counter.h"
+
+namespace lbj {
+
+Counter::Counter(Configuration &conf) : Basic(conf) {
+
+  // we need to see the cards
+  verbose = true;
+  conf.set(&n_decks, {"decks", "n_decks"});
+  conf.set(&max_bet, {"maximum_bet", "max_bet", "maxbet"});
+
+///conf+count_system+usage `count_system = ` { `hi-lo` | `ko` | `omega2` | `hi-opt1` | `hi-opt2` | `zen` | $w_A$ $w_2$ $w_3$ $w_4$ $w_5$ $w_6$ $w_7$ $w_8$ $w_9$ $w_T$ }
+///conf+count_system+details Card-counting system used by the `counter` player, either a known one
+///conf+count_system+details or the weights of each rank from the ace up to the ten-valued cards.
+///conf+count_system+details Balanced systems (e.g. `hi-lo` and `omega2`) bet and deviate by the true count,
+///conf+count_system+details i.e. the running count divided by the decks still in the shoe.
+///conf+count_system+details Unbalanced systems (e.g. `ko`) use the running count, which for `ko` starts at $4-4 \cdot \text{decks}$.
+///conf+count_system+details With `decks = 0` (an infinite shoe) the count does not change.
+///conf+count_system+default `hi-lo`
+///conf+count_system+example count_system = ko
+///conf+count_system+example count_system = -1 1 1 1 1 1 0 0 0 -1
+  std::string spec = "hi-lo";
+  conf.set(spec, {"count_system"});
+  if (system.set(spec, n_decks) != 0) {
+    std::cerr << "error: unknown count_system '" << spec << "'" << std::endl;
+    exit(1);
+  }
+  running_count = system.initial;
+
+///conf+bet_ramp+usage `bet_ramp = ` $c_1$`:`$b_1$ $c_2$`:`$b_2$ ...
+///conf+bet_ramp+details Units the `counter` player bets when the count (true or running, see `count_system`) is at least $c_i$.
+///conf+bet_ramp+details Below the first count it bets one unit. Bets are capped to `max_bet`, if given.
+///conf+bet_ramp+details It does not apply if `flat_bet` is true, because the dealer does not ask for bets.
+///conf+bet_ramp+default Empty, meaning a flat unit bet
+///conf+bet_ramp+example bet_ramp = 1:2 2:4 3:8 4:12
+  for (int i = 0; i < ramp_size; i++) {
+    ramp[i] = 1;
+  }
+  std::string ramp_spec;
+  if (conf.set(ramp_spec, {"bet_ramp", "ramp"})) {
+    std::istringstream iss(ramp_spec);
+    std::string step;
+    while (iss >> step) {
+      std::size_t colon = step.find(':');
+      int from = 0;
+      int bet = 0;
+      try {
+        from = std::stoi(step.substr(0, colon));
+        bet = (colon != std::string::npos) ? std::stoi(step.substr(colon + 1)) : -1;
+      } catch (...) {
+        bet = -1;
+      }
+      if (bet <= 0) {
+        std::cerr << "error: expected count:bet instead of '" << step << "' in bet_ramp" << std::endl;
+        exit(1);
+      }
+      for (int i = std::max(0, from - ramp_min); i < ramp_size; i++) {
+        ramp[i] = bet;
+      }
+    }
+  }
+  for (int i = 0; i < ramp_size; i++) {
+    ramp[i] = (max_bet != 0 && ramp[i] > max_bet) ? max_bet : ramp[i];
+  }
+
+///conf+deviations+usage `deviations = ` *hand* *upcard* *index* *action*`, ...`
+///conf+deviations+details Index plays of the `counter` player on top of the basic strategy, separated by commas.
+///conf+deviations+details The *hand* is written as in the strategy file (`h16`, `s18`, `p8`, `pT`, `pA`) or `ins` for insurance,
+///conf+deviations+details the *upcard* is `2`--`9`, `T` or `A`. The *action* is `h`, `s` or `d` for hard and soft hands
+///conf+deviations+details and `y` (split or insure) or `n` (do not split or do not insure) for pairs and insurance.
+///conf+deviations+details A pair that is not split is played as a hard or soft hand.
+///conf+deviations+details The action is taken if the count is at or above the *index*, or below it if the index starts with `<`.
+///conf+deviations+details Otherwise the basic strategy applies.
+///conf+deviations+default Empty, meaning no deviations
+///conf+deviations+example deviations = ins A 3 y, h16 T 0 s, h15 T 4 s, pT 5 5 y, pT 6 4 y, h10 T 4 d, h12 3 2 s
+///conf+deviations+example deviations = h13 2 <-1 h
+  std::string inline_deviations;
+  if (conf.set(inline_deviations, {"deviations"})) {
+    std::istringstream iss(inline_deviations);
+    if (read_deviations(iss, "deviations", ',') != 0) {
+      exit(1);
+    }
+  }
+
+///conf+deviations_file+usage `deviations_file = ` $\text{path to file}$
+///conf+deviations_file+details Same as `deviations` but with one index play per line in a file (`#` starts a comment).
+///conf+deviations_file+default Empty
+///conf+deviations_file+example deviations_file = illustrious18.txt
+  std::string deviations_file_path;
+  if (conf.set(deviations_file_path, {"deviations_file", "deviations_file_path"})) {
+    std::ifstream file_stream(deviations_file_path);
+    if (file_stream.is_open() == false) {
+      std::cerr << "error: cannot open deviations_file " << deviations_file_path << std::endl;
+      exit(1);
+    }
+    if (read_deviations(file_stream, deviations_file_path) != 0) {
+      exit(1);
+    }
+  }
+
+  return;
+}
+
+int Counter::read_deviations(std::istream &stream, const std::string &where, char separator) {
+  std::string line;
+  int n = 0;
+  while (std::getline(stream, line, separator)) {
+    n++;
+    line = line.substr(0, line.find('#'));
+    std::istringstream iss(line);
+    std::string hand, up, index, action;
+    if (!(iss >> hand)) {
+      continue;
+    }
+    if (!(iss >> up >> index >> action)) {
+      std::cerr << "error: expected hand upcard index action in " << where << ":" << n << std::endl;
+      return -1;
+    }
+
+    int upcard = 0;
+    if (up == "A" || up == "a") {
+      upcard = 11;
+    } else if (up == "T" || up == "t" || up == "10") {
+      upcard = 10;
+    } else if (up.size() == 1 && up[0] >= '2' && up[0] <= '9') {
+      upcard = up[0] - '0';
+    } else {
+      std::cerr << "error: unknown upcard '" << up << "' in " << where << ":" << n << std::endl;
+      return -1;
+    }
+
+    Deviation deviation;
+    deviation.below = (index[0] == '<');
+    try {
+      deviation.index = std::stod(index.substr((deviation.below || index[0] == '>') ? 1 : 0));
+    } catch (...) {
+      std::cerr << "error: invalid index '" << index << "' in " << where << ":" << n << std::endl;
+      return -1;
+    }
+    // the tables are indexed the same way as the basic strategy ones, and each one takes its own actions:
+    // h, s or d for hard and soft hands, y (split) or n (do not split) for pairs and y or n for insurance
+    Deviation *target = nullptr;
+    int value = 0;
+    char a = (action.size() == 1) ? std::tolower(action[0]) : '\0';
+    if (a != 'h' && a != 's' && a != 'd' && a != 'y' && a != 'n') {
+      std::cerr << "error: unknown action '" << action << "' in " << where << ":" << n << std::endl;
+      return -1;
+    }
+    if (hand == "ins" && upcard == 11) {
+      if (a == 'y' || a == 'n') {
+        target = &insurance_deviation;
+        deviation.action = (a == 'y') ? PlayerActionTaken::Insure : PlayerActionTaken::DontInsure;
+      }
+    } else if (hand.size() >= 2 && (hand[0] == 'p' || hand[0] == 'P')) {
+      value = (hand[1] == 'A' || hand[1] == 'a') ? 11 : ((hand[1] == 'T' || hand[1] == 't') ? 20 : 2 * std::atoi(hand.c_str() + 1));
+      if (value >= 4 && value <= 20 && (a == 'y' || a == 'n')) {
+        target = &pair_deviation[value][upcard];
+        // not splitting leaves the action as none so the hand is played as a regular one
+        deviation.action = (a == 'y') ? PlayerActionTaken::Split : PlayerActionTaken::None;
+      }
+    } else if (hand.size() >= 2 && (hand[0] == 'h' || hand[0] == 'H' || hand[0] == 's' || hand[0] == 'S')) {
+      value = std::atoi(hand.c_str() + 1);
+      if (value >= 4 && value <= 20 && a != 'y' && a != 'n') {
+        target = (hand[0] == 'h' || hand[0] == 'H') ? &hard_deviation[value][upcard] : &soft_deviation[value][upcard];
+        deviation.action = (a == 'h') ? PlayerActionTaken::Hit : ((a == 's') ? PlayerActionTaken::Stand : PlayerActionTaken::Double);
+      }
+    }
+    if (target == nullptr) {
+      std::cerr << "error: invalid deviation '" << line << "' (hard and soft hands take h, s or d, pairs and insurance y or n) in " << where << ":" << n << std::endl;
+      return -1;
+    }
+    deviation.set = true;
+    *target = deviation;
+    n_deviations++;
+  }
+
+  return 0;
+}
+
+void Counter::info(lbj::Info msg, int64_t p1, int64_t p2) {
+  switch (msg) {
+    case lbj::Info::NewHand:
+      Basic::info(msg, p1, p2);
+    break;
+    case lbj::Info::Shuffle:
+      running_count = system.initial;
+      n_seen = 0;
+    break;
+    case lbj::Info::CardPlayer:
+    case lbj::Info::CardDealer:
+    case lbj::Info::CardDealerRevealsHole:
+      // the hole card comes as zero until it is revealed, and there is nothing to count in an infinite shoe
+      if (n_decks != 0 && p1 > 0 && p1 <= 52) {
+        running_count += system.weight[p1];
+        n_seen++;
+      }
+    break;
+    default:
+    break;
+  }
+  return;
+}
+
+int Counter::play() {
+
+  double c = count();
+
+  switch (actionRequired) {
+    case PlayerActionRequired::Bet:
+      {
+        int i = static_cast<int>(std::floor(c)) - ramp_min;
+        current_bet = betting.bet(ramp[(i < 0) ? 0 : ((i >= ramp_size) ? ramp_size - 1 : i)], c);
+        actionTaken = PlayerActionTaken::Bet;
+      }
+    break;
+
+    case PlayerActionRequired::Insurance:
+      actionTaken = applies(insurance_deviation, c) ? affordable(insurance_deviation.action, 0, 0) : PlayerActionTaken::DontInsure;
+    break;
+
+    case PlayerActionRequired::Play:
+      {
+        std::size_t value = std::abs(value_player);
+        std::size_t upcard = std::abs(value_dealer);
+        actionTaken = basicAction(value, upcard);
+
+        if (can_split) {
+          const Deviation &deviation = pair_deviation[(value_player == -12) ? 11 : value][upcard];
+          if (applies(deviation, c)) {
+            // either split or play it as a regular hand
+            actionTaken = (deviation.action == PlayerActionTaken::Split) ? PlayerActionTaken::Split : hardOrSoft(value, upcard);
+            deviations_taken++;
+          }
+        }
+        if (actionTaken != PlayerActionTaken::Split) {
+          const Deviation &deviation = (value_player < 0) ? soft_deviation[value][upcard] : hard_deviation[value][upcard];
+          if (applies(deviation, c)) {
+            actionTaken = (deviation.action == PlayerActionTaken::Double && can_double == false) ? PlayerActionTaken::Hit : deviation.action;
+            deviations_taken++;
+          }
+        }
+        actionTaken = affordable(actionTaken, value, upcard);
+      }
+    break;
+
+    case PlayerActionRequired::None:
+    break;
+  }
+
+  return 0;
+}
+
+std::string Counter::signature(void) {
+  std::ostringstream oss;
+  oss << Basic::signature();
+  oss << "count_system =";
+  for (unsigned int tag = 1; tag <= 13; tag++) {
+    oss << " " << system.weight[tag];
+  }
+  oss << " (" << system.initial << ")" << std::endl;
+  oss << "bet_ramp =";
+  for (int i = 0; i < ramp_size; i++) {
+    oss << " " << ramp[i];
+  }
+  oss << std::endl;
+  oss << "deviations =";
+  auto print = [&oss](const char *table, int value, int upcard, const Deviation &deviation) {
+    if (deviation.set) {
+      oss << " " << table << value << "/" << upcard << ((deviation.below) ? "<" : ">=") << deviation.index << ":" << static_cast<int>(deviation.action);
+    }
+  };
+  for (int value = 0; value < 21; value++) {
+    for (int upcard = 0; upcard < 12; upcard++) {
+      print("h", value, upcard, hard_deviation[value][upcard]);
+      print("s", value, upcard, soft_deviation[value][upcard]);
+      print("p", value, upcard, pair_deviation[value][upcard]);
+    }
+  }
+  print("i", 0, 11, insurance_deviation);
+  oss << std::endl;
+  return oss.str();
+}
+
+void Counter::report(std::list<reportItem> &report) {
+  Basic::report(report);
+  report.push_back(reportItem(3, "count_system", system.name));
+  report.push_back(reportItem(3, "deviations", static_cast<double>(n_deviations)));
+  report.push_back(reportItem(3, "deviations_taken", static_cast<double>(deviations_taken)));
+  return;
+}
+}
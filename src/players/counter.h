@@ -0,0 +1,79 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - card-counting internal player
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+
+#ifndef COUNTER_H
+#define COUNTER_H
+#include "basic.h"
+
+namespace lbj {
+
+class Counter : public Basic {
+  public:
+    Counter(Configuration &);
+    ~Counter() { };
+
+    int play(void) override;
+    void info(lbj::Info = lbj::Info::None, int64_t p1 = 0, int64_t p2 = 0) override;
+    std::string signature(void) override;
+    void report(std::list<reportItem> &) override;
+
+    // the true count for balanced systems and the running count for unbalanced ones
+    inline double count(void) const {
+      if (system.balanced == false) {
+        return running_count;
+      }
+      return (n_seen >= 52 * n_decks) ? 0 : 52.0 * running_count / (52 * n_decks - n_seen);
+    }
+
+  private:
+    struct Deviation {
+      bool set = false;
+      PlayerActionTaken action = PlayerActionTaken::None;   // none for a pair means do not split
+      bool below = false;   // the action is taken if the count is below the index instead of at or above it
+      double index = 0;
+    };
+
+    inline bool applies(const Deviation &deviation, double c) const {
+      return deviation.set && ((deviation.below) ? (c < deviation.index) : (c >= deviation.index));
+    }
+    int read_deviations(std::istream &, const std::string &, char = '\n');
+
+    CountSystem system;
+    unsigned int n_decks = 0;
+    unsigned int max_bet = 0;
+    int running_count = 0;
+    unsigned int n_seen = 0;
+
+    // bet for each integer count from ramp_min up, the ends apply to everything beyond them
+    static const int ramp_min = -10;
+    static const int ramp_size = 41;
+    unsigned int ramp[ramp_size];
+
+    Deviation hard_deviation[21][12];
+    Deviation soft_deviation[21][12];
+    Deviation pair_deviation[21][12];
+    Deviation insurance_deviation;
+    size_t n_deviations = 0;
+    uint64_t deviations_taken = 0;
+};
+}
+#endif
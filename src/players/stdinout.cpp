@@ -22,23 +22,28 @@
 
 #include <iostream>
 #include <sstream>
+#include <cerrno>
+
+#include <poll.h>
+#include <unistd.h>
 
 #include "../conf.h"
 #include "../blackjack.h"
 #include "stdinout.h"
+#include "basic.h"
 
 namespace lbj {
 
-std::string double_to_string_g_format(double value) {
-#ifdef HAS_CPP_20
-  // C++20 implementation using std::format
-  return std::format("{}", value);
-#else
-  // Pre-C++20 implementation using stringstream
-  std::ostringstream oss;
-  oss << value;
-  return oss.str();
-#endif
+// money comes in thousandths of a unit, we write it exactly and without trailing zeros
+std::string money_to_string(int64_t value) {
+  uint64_t magnitude = (value < 0) ? -static_cast<uint64_t>(value) : value;
+  std::string s = ((value < 0) ? "-" : "") + std::to_string(magnitude / money_unit);
+  uint64_t fraction = magnitude % money_unit;
+  if (fraction != 0) {
+    std::string digits = std::to_string(money_unit + fraction).substr(1);
+    s += "." + digits.substr(0, digits.find_last_not_of('0') + 1);
+  }
+  return s;
 }
 
 StdInOut::StdInOut(Configuration &conf) : Player(conf) {
@@ -48,10 +53,43 @@ StdInOut::StdInOut(Configuration &conf) : Player(conf) {
     conf.set(&verbose, {"verbose"});
   }
 
+///conf+decision_timeout+usage `decision_timeout = ` $t$
+///conf+decision_timeout+details If $t$ is positive, an external (`stdinout`) player has $t$ seconds to answer each
+///conf+decision_timeout+details `bet?`, `insurance?` or `play?` question. If the answer does not come in time,
+///conf+decision_timeout+details the dealer takes the action given by `decision_timeout_action` on behalf of the player
+///conf+decision_timeout+details and counts a timeout in the report. The player is still expected to answer every
+///conf+decision_timeout+details question, the late answers are read and discarded before the next one.
+///conf+decision_timeout+default $0$, meaning wait forever
+///conf+decision_timeout+example decision_timeout = 0.5
+///conf+decision_timeout+example decision_timeout = 10
+  conf.set(&decision_timeout, {"decision_timeout"});
+
+///conf+decision_timeout_action+usage `decision_timeout_action = ` `basic` | `stand` | `quit`
+///conf+decision_timeout_action+details What the dealer does when the external player does not answer within `decision_timeout`.
+///conf+decision_timeout_action+details With `basic` the question is answered by the internal player (i.e. following the
+///conf+decision_timeout_action+details strategy in `strategy_file`, flat bets and no insurance). With `stand` the bet is one unit,
+///conf+decision_timeout_action+details insurance is declined and the hand stands. With `quit` the game finishes.
+///conf+decision_timeout_action+default `basic`
+///conf+decision_timeout_action+example decision_timeout_action = stand
+  conf.set(decision_timeout_action, {"decision_timeout_action"});
+
+  if (decision_timeout > 0) {
+    if (decision_timeout_action == "basic") {
+      fallback = new Basic(conf);
+    } else if (decision_timeout_action != "stand" && decision_timeout_action != "quit") {
+      std::cerr << "error: decision_timeout_action should be either basic, stand or quit and not '" << decision_timeout_action << "'" << std::endl;
+      exit(1);
+    }
+  }
+
   return;
 }
 
-void StdInOut::info(lbj::Info msg, int p1, int p2) {
+StdInOut::~StdInOut() {
+  delete fallback;
+}
+
+void StdInOut::info(lbj::Info msg, int64_t p1, int64_t p2) {
 
   std::string s;
 
@@ -79,7 +117,7 @@ void StdInOut::info(lbj::Info msg, int p1, int p2) {
 ///inf+new_hand+example new_hand 1 0
 ///inf+new_hand+example new_hand 22 -8
 ///inf+new_hand+example new_hand 24998 -7609.5
-      s = "new_hand " + std::to_string(p1) + " " + double_to_string_g_format(1e-3*p2);
+      s = "new_hand " + std::to_string(p1) + " " + money_to_string(p2);
     break;
 
     case lbj::Info::BetInvalid:
@@ -90,6 +128,13 @@ void StdInOut::info(lbj::Info msg, int p1, int p2) {
 ///inf+bet_negative+details The player will receive a new `bet?` message.
 ///inf+bet_negative+example bet_negative
         s = "bet_negative" + std::to_string(p1);  
+      } else if (p1 > 0 && p1 < p2) {
+///inf+bet_minimum+usage `bet_minimum` $b$ $m$
+///inf+bet_minimum+details The dealer complains that the bet $b$ the placer placed is invalid.
+///inf+bet_minimum+details The bet is smaller than the minimum wager $m$ set by `minimum_bet`.
+///inf+bet_minimum+details The player will receive a new `bet?` message.
+///inf+bet_minimum+example bet_minimum 1 5
+        s = "bet_minimum " + std::to_string(p1) + " " + std::to_string(p2);
       } else if (p1 > 0) {
 ///inf+bet_maximum+usage `bet_maximum`
 ///inf+bet_maximum+details The dealer complains that the bet the placer placed is invalid.
@@ -285,7 +330,7 @@ void StdInOut::info(lbj::Info msg, int p1, int p2) {
     break;
 
     case lbj::Info::Bankroll:
-      s = "bankroll " + std::to_string(1e-3*p1);
+      s = "bankroll " + money_to_string(p1);
     break;
     
     
@@ -358,15 +403,31 @@ int StdInOut::play(void) {
     break;
   }
 
+  // with a single core the player might answer before write() returns
+  // so we start the clock before asking
+  uint64_t asked = Timing::now();
   std::cout << s << std::endl;
   
+  uint64_t deadline = (decision_timeout > 0) ? asked + static_cast<uint64_t>(1e9 * decision_timeout) : 0;
+
   std::string command;
-  std::cin >> command;
+  int got = readToken(command, deadline);
+  // answers to questions that already timed out are not for this one
+  while (got == 1 && owed_answers != 0) {
+    owed_answers--;
+    late_answers++;
+    got = readToken(command, deadline);
+  }
 
-  if (std::cin.eof()) {
+  if (got == 0) {
     actionTaken = lbj::PlayerActionTaken::Quit;
     return 0;
+  } else if (got < 0) {
+    timeouts++;
+    owed_answers++;
+    return timeout();
   }
+  latency.add(Timing::now() - asked);
 
   trim(command);
   actionTaken = lbj::PlayerActionTaken::None;
@@ -431,4 +492,105 @@ int StdInOut::play(void) {
   return 0;
 
 }
+// we do our own buffering instead of std::cin so poll() knows
+// whether the player already sent something or not
+int StdInOut::readToken(std::string &token, uint64_t deadline) {
+
+  while (true) {
+    std::size_t begin = input_buffer.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+      input_buffer.clear();
+    } else {
+      std::size_t end = input_buffer.find_first_of(" \t\r\n", begin);
+      if (end != std::string::npos) {
+        token.assign(input_buffer, begin, end - begin);
+        input_buffer.erase(0, end);
+        return 1;
+      }
+    }
+
+    if (deadline != 0) {
+      uint64_t now = Timing::now();
+      if (now >= deadline) {
+        return -1;
+      }
+      // round up so we do not spin during the last millisecond (and wake up
+      // every now and then so long timeouts do not overflow the int)
+      uint64_t ms = std::min<uint64_t>((deadline - now + 999999) / 1000000, 1000000);
+      struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+      int ready = poll(&input, 1, static_cast<int>(ms));
+      if (ready == 0 || (ready < 0 && errno == EINTR)) {
+        continue;
+      }
+    }
+
+    char chunk[256];
+    ssize_t n = read(STDIN_FILENO, chunk, sizeof(chunk));
+    if (n > 0) {
+      input_buffer.append(chunk, n);
+    } else if (n == 0 || errno != EINTR) {
+      // the last token need not have a trailing newline
+      if (begin != std::string::npos) {
+        token.assign(input_buffer, begin, std::string::npos);
+        input_buffer.clear();
+        return 1;
+      }
+      return 0;
+    }
+  }
+}
+
+int StdInOut::timeout(void) {
+
+  if (decision_timeout_action == "quit") {
+    actionTaken = lbj::PlayerActionTaken::Quit;
+    
+  } else if (fallback != nullptr) {
+    fallback->actionRequired = actionRequired;
+    fallback->value_player = value_player;
+    fallback->value_dealer = value_dealer;
+    fallback->can_double = can_double;
+    fallback->can_split = can_split;
+    fallback->play();
+    actionTaken = fallback->actionTaken;
+    current_bet = fallback->current_bet;
+    
+  } else {
+    switch (actionRequired) {
+      case lbj::PlayerActionRequired::Bet:
+        current_bet = 1;
+        actionTaken = lbj::PlayerActionTaken::Bet;
+      break;
+      case lbj::PlayerActionRequired::Insurance:
+        actionTaken = lbj::PlayerActionTaken::DontInsure;
+      break;
+      case lbj::PlayerActionRequired::Play:
+        actionTaken = lbj::PlayerActionTaken::Stand;
+      break;
+      case lbj::PlayerActionRequired::None:
+      break;
+    }
+  }
+
+  return 0;
+}
+
+void StdInOut::report(std::list<reportItem> &report) {
+
+  // timeouts change the way the player plays so they go with the results
+  if (decision_timeout > 0) {
+    report.push_back(reportItem(3, "decision_timeouts",     timeouts));
+    report.push_back(reportItem(3, "decision_late_answers", late_answers));
+  }
+
+  // the ones that timed out are not in the histogram
+  report.push_back(reportItem(6, "decisions",                  latency.n));
+  if (latency.n != 0) {
+    report.push_back(reportItem(6, "decision_latency_p50_ns",  latency.quantile(0.50)));
+    report.push_back(reportItem(6, "decision_latency_p99_ns",  latency.quantile(0.99)));
+    report.push_back(reportItem(6, "decision_latency_max_ns",  latency.max));
+  }
+
+  return;
+}
 }
@@ -34,13 +34,30 @@ namespace lbj {
 class StdInOut : public Player {
   public:  
     StdInOut(Configuration &);
-    ~StdInOut() { };
+    ~StdInOut();
     
     int play(void) override;
-    void info(lbj::Info = lbj::Info::None, int = 0, int = 0) override;
+    void info(lbj::Info = lbj::Info::None, int64_t = 0, int64_t = 0) override;
+    void report(std::list<reportItem> &) override;
     
   private:
+    // next whitespace-separated token, 1 if there is one, 0 at the end of the input
+    // and -1 if the deadline (in Timing::now() nanoseconds, zero means none) expired
+    int readToken(std::string &, uint64_t);
+    // answer on behalf of the player according to decision_timeout_action
+    int timeout(void);
     std::string input_buffer;
+
+    // time between asking and getting an answer
+    Histogram latency;
+
+    // what to do if the answer does not come in time
+    double decision_timeout = 0;
+    std::string decision_timeout_action{"basic"};
+    Player *fallback = nullptr;
+    std::size_t timeouts = 0;
+    std::size_t late_answers = 0;
+    std::size_t owed_answers = 0;
     
     std::size_t hand_to_split;
     unsigned int card_to_split;
@@ -39,7 +39,7 @@ namespace lbj {
 std::vector<std::string> commands;
 
 // TODO: think of a better way
-extern std::string double_to_string_g_format(double value);
+extern std::string money_to_string(int64_t value);
 
 
 Tty::Tty(Configuration &conf) : Player(conf) {
@@ -89,7 +89,7 @@ Tty::Tty(Configuration &conf) : Player(conf) {
   return;
 }
 
-void Tty::info(lbj::Info msg, int p1, int p2) {
+void Tty::info(lbj::Info msg, int64_t p1, int64_t p2) {
   std::string s;
   bool render = false;
   
@@ -100,6 +100,8 @@ void Tty::info(lbj::Info msg, int p1, int p2) {
     case lbj::Info::BetInvalid:
       if (p1 < 0) {
         s = "Your bet is negative (" + std::to_string(p1) + ")";
+      } else if (p1 > 0 && p1 < p2) {
+        s = "Your bet is smaller than the minimum allowed (" + std::to_string(p2) + ")";
       } else if (p1 > 0) {
         s = "Your bet is larger than the maximum allowed (" + std::to_string(p1) + ")";
       } else {
@@ -109,7 +111,7 @@ void Tty::info(lbj::Info msg, int p1, int p2) {
 
     case lbj::Info::NewHand:
       std::cout << std::endl;
-      s = "Starting new hand #" + std::to_string(p1) + " with bankroll " + double_to_string_g_format(1e-3*p2);
+      s = "Starting new hand #" + std::to_string(p1) + " with bankroll " + money_to_string(p2);
       
       // clear dealer's hand
       dealerHand.cards.clear();
@@ -227,12 +229,12 @@ void Tty::info(lbj::Info msg, int p1, int p2) {
     break;
     
     case lbj::Info::PlayerPushes:
-      s = "Player pushes " + double_to_string_g_format(1e-3*p1) + ((p2 > 0) ? (" with " + std::to_string(p2)) : "");
+      s = "Player pushes " + money_to_string(p1) + ((p2 > 0) ? (" with " + std::to_string(p2)) : "");
       render = true;
     break;
     
     case lbj::Info::PlayerLosses:
-      s = "Player losses " + double_to_string_g_format(1e-3*p1) + ((p2 > 0) ? (" with " + std::to_string(p2)) : "");
+      s = "Player losses " + money_to_string(p1) + ((p2 > 0) ? (" with " + std::to_string(p2)) : "");
       render = true;
     break;
     case lbj::Info::PlayerBlackjack:
@@ -240,7 +242,7 @@ void Tty::info(lbj::Info msg, int p1, int p2) {
       render = true;
     break;
     case lbj::Info::PlayerWins:
-      s = "Player wins " + double_to_string_g_format(1e-3*p1) + ((p2 > 0) ? (" with " + std::to_string(p2)) : "");
+      s = "Player wins " + money_to_string(p1) + ((p2 > 0) ? (" with " + std::to_string(p2)) : "");
       render = true;
     break;
     
@@ -267,7 +269,7 @@ void Tty::info(lbj::Info msg, int p1, int p2) {
     break;
 
     case lbj::Info::Bankroll:
-      std::cout << "Your bankroll is " << double_to_string_g_format(1e-3*p1) << std::endl;        
+      std::cout << "Your bankroll is " << money_to_string(p1) << std::endl;        
     break;
     
     
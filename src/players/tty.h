@@ -39,7 +39,7 @@ class Tty : public Player {
     ~Tty() { };
     
     int play(void) override;
-    void info(lbj::Info = lbj::Info::None, int = 0, int = 0) override;
+    void info(lbj::Info = lbj::Info::None, int64_t = 0, int64_t = 0) override;
 
     // for readline's autocompletion
     static char *rl_command_generator(const char *, int);
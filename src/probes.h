@@ -0,0 +1,54 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - static tracepoints
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+
+#ifndef PROBES_H
+#define PROBES_H
+
+// USDT probes under the provider "libreblackjack", they cost a nop when nobody is attached:
+//
+//   round_start     hand number, bankroll (in thousandths)
+//   round_settled   hand number, outcome of the hand (in thousandths), the last one when the final report is prepared
+//   card_drawn      card tag (1--52), position in the shoe (zero for infinite decks)
+//   decision        action taken (PlayerActionTaken), player's value, dealer's upcard value
+//   basic_decision  same as decision but from within the internal player
+//   shuffle_start   number of decks
+//   shuffle_end     number of shuffles so far
+//
+// for example
+//
+//   bpftrace -e 'usdt:./blackjack:libreblackjack:round_start { @s = nsecs }
+//                usdt:./blackjack:libreblackjack:round_settled /@s/ { @ns = hist(nsecs - @s) }'
+//
+// if sys/sdt.h is not available (or configure got --disable-probes) they expand to nothing
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#define LBJ_PROBE1(name, a)        DTRACE_PROBE1(libreblackjack, name, a)
+#define LBJ_PROBE2(name, a, b)     DTRACE_PROBE2(libreblackjack, name, a, b)
+#define LBJ_PROBE3(name, a, b, c)  DTRACE_PROBE3(libreblackjack, name, a, b, c)
+#else
+#define LBJ_PROBE1(name, a)        do { } while (0)
+#define LBJ_PROBE2(name, a, b)     do { } while (0)
+#define LBJ_PROBE3(name, a, b, c)  do { } while (0)
+#endif
+
+#endif
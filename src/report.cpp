@@ -7,21 +7,39 @@
 #include <string>
 
 #include "dealer.h"
+#include "probes.h"
 
 
 // TODO: make a separate report class and construct with the dealer & player
 namespace lbj {
 
+// adds x to sum + c with Neumaier's compensated summation and then
+// renormalizes so sum alone is the correctly-rounded total
+static inline void compensated_add(double &sum, double &c, double x) {
+  double t = sum + x;
+  c += (std::abs(sum) >= std::abs(x)) ? (sum - t) + x : (x - t) + sum;
+  sum = t + c;
+  c -= sum - t;
+  return;
+}
+
+// Welford's algorithm, with increments of order 1/n on a mean of order
+// 1e-2 (and of order 1 on an M2 of order n) plain additions lose most of
+// their bits after 1e10 hands so we keep the lost bits in mean_c and M2_c
 void Dealer::updateMeanAndVariance(void) {
-  double delta = playerStats.currentOutcome - playerStats.mean;
-  playerStats.mean += delta / (double)(n_hand);
-  playerStats.M2 += delta * (playerStats.currentOutcome - playerStats.mean);
+  double outcome = playerStats.currentOutcome / static_cast<double>(money_unit);
+  double delta = (outcome - playerStats.mean) - playerStats.mean_c;
+  compensated_add(playerStats.mean, playerStats.mean_c, delta / (double)(n_hand));
+  compensated_add(playerStats.M2, playerStats.M2_c, delta * ((outcome - playerStats.mean) - playerStats.mean_c));
   playerStats.variance = playerStats.M2 / (double)(n_hand-1);
+  if (playerStats.profile.enabled()) {
+    playerStats.profile.settle(outcome);
+  }
   return;
 }
 
 
-void Dealer::prepareReport(void) {
+void Dealer::prepareReport(bool final) {
 
   // TODO: if n_hand is one the error is NaN
 /*  
@@ -30,8 +48,30 @@ void Dealer::prepareReport(void) {
   }
 */
 
+#ifdef ALLOC_COUNT
+  // before we start building the report, which does allocate
+  uint64_t allocations_end = allocations();
+#endif
+
   // we need to update these statistics after the last played hand
-  updateMeanAndVariance();  
+  // (which is settled now and not when the next one starts, unless this is an interim report)
+  if (n_hand != 0) {
+    if (final) {
+      LBJ_PROBE2(round_settled, n_hand, playerStats.currentOutcome);
+    }
+    updateMeanAndVariance();
+  }
+  if (final) {
+    writeStatus(true);
+  }
+
+  // throughput is about this run only, so we need it before merging
+  double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  double cpu_time = Timing::cpu() - cpu_start;
+  size_t hands_played = n_hand;
+
+  // and then add whatever previous runs with the same configuration had
+  mergeResultsCache();
     
   double total = static_cast<double>(n_hand);
   double error = error_standard_deviations * sqrt (playerStats.variance / total);
@@ -61,7 +101,15 @@ void Dealer::prepareReport(void) {
   report.push_back(reportItem(2, "mean",      playerStats.mean));
   report.push_back(reportItem(2, "error",     error));
   report.push_back(reportItem(2, "hands",     n_hand));
-  report.push_back(reportItem(2, "bankroll",  playerStats.bankroll));
+  if (n_merged != 0) {
+    report.push_back(reportItem(2, "merged_reports", n_merged));
+  } else if (n_hands_cached != 0) {
+    report.push_back(reportItem(2, "hands_cached", n_hands_cached));
+  }
+  if (shard_count != 0) {
+    report.push_back(reportItem(2, "shard", std::to_string(shard_index) + "/" + std::to_string(shard_count)));
+  }
+  report.push_back(reportItem(2, "bankroll",  playerStats.bankroll / static_cast<double>(money_unit)));
 
 
   report.push_back(reportItem(3, "busts_player_n",     playerStats.bustsPlayer));
@@ -89,11 +137,117 @@ void Dealer::prepareReport(void) {
 
   report.push_back(reportItem(5, "variance",  playerStats.variance));
   report.push_back(reportItem(5, "deviation", sqrt(playerStats.variance)));
+
+  report.push_back(reportItem(6, "wall_time",         wall_time));
+  report.push_back(reportItem(6, "cpu_time",          cpu_time));
+  report.push_back(reportItem(6, "cards",             n_cards));
+  report.push_back(reportItem(6, "shuffles",          n_shuffles));
+  report.push_back(reportItem(6, "hands_per_second",  hands_played / wall_time));
+  report.push_back(reportItem(6, "cards_per_second",  n_cards / wall_time));
+#ifdef COUNTERS
+  for (unsigned int i = 0; i < sizeof(events.transitions)/sizeof(*events.transitions); i++) {
+    report.push_back(reportItem(6, std::string("transitions_") + dealer_action_names[i], events.transitions[i]));
+  }
+  for (unsigned int i = 0; i < sizeof(events.actions)/sizeof(*events.actions); i++) {
+    report.push_back(reportItem(6, std::string("actions_") + player_action_names[i], events.actions[i]));
+  }
+  report.push_back(reportItem(6, "arranged_hits",     events.arranged_hits));
+  report.push_back(reportItem(6, "arranged_misses",   events.arranged_misses));
+  for (int depth = 1; depth <= Events::max_split_depth; depth++) {
+    if (events.splits[depth] != 0) {
+      report.push_back(reportItem(6, "splits_depth_" + std::to_string(depth), events.splits[depth]));
+    }
+  }
+  report.push_back(reportItem(6, "dealer_hits",       events.dealer_hits));
+  report.push_back(reportItem(6, "rejected_commands", events.rejected_commands));
+#endif
+  if (perf_requested) {
+    if (perf.available()) {
+      for (const auto &counter : perf.counters) {
+        double value = perf.value(counter);
+        report.push_back(reportItem(6, "perf_" + counter.name,               value));
+        report.push_back(reportItem(6, "perf_" + counter.name + "_per_hand", (hands_played != 0) ? value / hands_played : 0));
+        report.push_back(reportItem(6, "perf_" + counter.name + "_per_card", (n_cards != 0) ? value / n_cards : 0));
+      }
+    }
+    if (perf.reason.empty() == false) {
+      report.push_back(reportItem(6, "perf_unavailable", perf.reason));
+    }
+  }
+#ifdef ALLOC_COUNT
+  report.push_back(reportItem(6, "allocations", allocations_end));
+  if (hands_played > allocs.warmup) {
+    report.push_back(reportItem(6, "allocations_per_hand", (allocations_end - allocs.start) / (double)(hands_played - allocs.warmup)));
+  }
+#endif
+#ifdef TIMING
+  // shuffling is always timed, the rest is extrapolated from the sampled hands
+  const char *phases[] = {"shuffle", "draw", "play", "settlement"};
+  report.push_back(reportItem(6, "timing_sampled_hands", timing.sampled_hands));
+  for (int i = 0; i < static_cast<int>(Phase::Count); i++) {
+    double scale = (i == static_cast<int>(Phase::Shuffle) || timing.sampled_hands == 0) ? 1.0 : hands_played / (double)(timing.sampled_hands);
+    report.push_back(reportItem(6, std::string("time_") + phases[i], 1e-9 * timing.ns[i] * scale));
+    report.push_back(reportItem(6, std::string("time_") + phases[i] + "_per_call_ns", (timing.calls[i] != 0) ? timing.ns[i] / (double)(timing.calls[i]) : 0));
+  }
+#endif
+
+  // and whatever the player has to say (e.g. how long external players take to answer)
+  player->report(report);
     
 
   return;
 }
 
+// prepareReport() accumulates the last hand and merges the cache, so we
+// work on the live accumulators and then put them back as they were
+// (the results cache, if any, is also written so this is a checkpoint)
+int Dealer::writeInterimReport(void) {
+  auto stats = playerStats;
+  size_t hands = n_hand;
+  std::string file_path = report_file_path;
+  
+  report_file_path = interim_report_file_path;
+  prepareReport(false);
+  int result = writeReportYAML();
+  writeResultsCache();
+  report.clear();
+
+  report_file_path = file_path;
+  n_hand = hands;
+  playerStats = stats;
+  // the copy's iterator points to the copied list, not to ours
+  playerStats.currentHand = playerStats.hands.begin();
+
+  return result;
+}
+
+std::string report_value(const reportItem &item, bool quote) {
+  std::ostringstream value;
+  if (item.string != "") {
+    if (quote) {
+      value << "\"" << item.string << "\"";
+    } else {
+      value << item.string;
+    }
+  } else if (std::floor(item.value) == item.value && std::abs(item.value) < 9007199254740992.0) {
+    // counters are exact up to 2^53, do not let them become 4.29497e+09
+    value << static_cast<long long>(item.value);
+  } else {
+    value << item.value;
+  }
+  return value.str();
+}
+
+std::list<reportItem> Dealer::reportItems(void) {
+  std::list<reportItem> items;
+  for (auto &item : report) {
+    if (item.level <= report_verbosity) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
 int Dealer::writeReportYAML(void) {
     
   // if (n_hand <= 1) {
@@ -121,15 +275,30 @@ int Dealer::writeReportYAML(void) {
   *out << "---" << std::endl; 
   for (auto &item : report) {
     if (item.level <= report_verbosity) {
-      *out << item.key << ": ";
-        
-      if (item.string != "") {
-        *out << "\"" << item.string << "\"";  // This assumes item.value can be streamed directly
-      } else{
-        *out << item.value;  
+      *out << item.key << ": " << report_value(item, true) << std::endl;
+    }
+  }
+
+  // a table does not fit into key: value items
+  const EdgeProfile &profile = playerStats.profile;
+  if (profile.enabled()) {
+    uint64_t total = 0;
+    for (auto &bin : profile.bins) {
+      total += bin.n;
+    }
+    *out << "edge_profile:" << std::endl;
+    for (int i = 0; i < profile.n_counts; i++) {
+      for (unsigned int j = 0; j < profile.n_depths; j++) {
+        const Running &bin = profile.bins[i * profile.n_depths + j];
+        if (bin.n != 0) {
+          *out << "  - count: " << profile.min_count + i << std::endl;
+          *out << "    depth: " << j / static_cast<double>(profile.n_depths) << std::endl;
+          *out << "    hands: " << bin.n << std::endl;
+          *out << "    frequency: " << bin.n / static_cast<double>(total) << std::endl;
+          *out << "    mean: " << bin.mean << std::endl;
+          *out << "    error: " << error_standard_deviations * std::sqrt(bin.variance() / bin.n) << std::endl;
+        }
       }
-        
-      *out << std::endl;
     }
   }
   *out << "..." << std::endl;
@@ -0,0 +1,110 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - live status and convergence trace
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "dealer.h"
+
+namespace lbj {
+
+// resident set size in kilobytes
+static long rss_kb(void) {
+  // the current one if we have proc, otherwise the peak
+  std::ifstream statm("/proc/self/statm");
+  long pages_total = 0;
+  long pages_resident = 0;
+  if (statm >> pages_total >> pages_resident) {
+    return pages_resident * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+void Dealer::writeStatus(bool final) {
+
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  double hands_per_second = (elapsed > 0) ? n_hand / elapsed : 0;
+  double error = (n_hand > 1) ? error_standard_deviations * std::sqrt(playerStats.variance / n_hand) : 0;
+
+  if (n_hand >= next_convergence_hand) {
+    std::ofstream file_stream(convergence_file_path, std::ios::app);
+    file_stream << n_hand << "\t" << hands_per_second << "\t" << elapsed << "\t"
+                << playerStats.mean << "\t" << error << "\t" << rss_kb() << std::endl;
+
+    // 1, 2, 5, 10, 20, 50, ...
+    size_t decade = 1;
+    while (10 * decade <= next_convergence_hand) {
+      decade *= 10;
+    }
+    size_t mantissa = next_convergence_hand / decade;
+    next_convergence_hand = ((mantissa == 1) ? 2 : ((mantissa == 2) ? 5 : 10)) * decade;
+  }
+
+  if (status_file_path.empty() == false && (final || elapsed - status_last >= status_interval)) {
+    status_last = elapsed;
+
+    double eta = (n_hands > 0 && hands_per_second > 0) ? (n_hands - std::min(n_hand, n_hands)) / hands_per_second : 0;
+
+    // write and rename so the readers never see half a file
+    std::string tmp_path = status_file_path + ".tmp";
+    std::ofstream file_stream(tmp_path);
+    if (file_stream.is_open()) {
+      file_stream << "---" << std::endl;
+      file_stream << "hands: " << n_hand << std::endl;
+      file_stream << "hands_total: " << n_hands << std::endl;
+      file_stream << "hands_per_second: " << hands_per_second << std::endl;
+      file_stream << "elapsed: " << elapsed << std::endl;
+      file_stream << "eta: " << eta << std::endl;
+      file_stream << "mean: " << playerStats.mean << std::endl;
+      file_stream << "error: " << error << std::endl;
+      file_stream << "rss_kb: " << rss_kb() << std::endl;
+      file_stream << "finished: " << (final ? "true" : "false") << std::endl;
+      file_stream << "..." << std::endl;
+      file_stream.close();
+      std::rename(tmp_path.c_str(), status_file_path.c_str());
+    }
+  }
+
+  if (control) {
+    control->publish(n_hand, n_hands, elapsed, playerStats.mean, error, report_verbosity, paused);
+  }
+
+  if (status_file_path.empty() == false || control) {
+    next_status_hand = std::min(n_hand + status_check_hands, next_convergence_hand);
+  } else {
+    next_status_hand = next_convergence_hand;
+  }
+
+  return;
+}
+}
@@ -0,0 +1,271 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - parameter sweeps
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <cstdlib>
+
+#include "dealer.h"
+#include "blackjack.h"
+#include "players/basic.h"
+
+namespace lbj {
+
+// every point of a sweep (or every rule set of a delta) is played by its own dealer, these would step on each other
+static const char * const per_run_keys[] = {
+  "results_cache", "cache",
+  "raw_report", "raw_report_file", "raw_report_file_path",
+  "shard",
+  "status_file", "status_file_path", "status",
+  "convergence_file", "convergence_trace",
+  "control_socket", "control",
+};
+
+// YAML wants strings quoted only if they could be taken as something else
+static std::string yaml_value(const std::string &value) {
+  char *end = nullptr;
+  std::strtod(value.c_str(), &end);
+  return (value.empty() == false && *end == '\0') ? value : "\"" + value + "\"";
+}
+
+int reject_per_run_settings(Configuration &conf, const std::string &what) {
+  if (conf.getPlayerName() != "internal" && conf.getPlayerName() != "basic") {
+    std::cerr << "error: " << what << " can only be played by the internal player" << std::endl;
+    return -1;
+  }
+  for (auto key : per_run_keys) {
+    if (conf.exists(key)) {
+      std::cerr << "error: setting " << key << " cannot be used in " << what << std::endl;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int sweep(Configuration &conf) {
+
+  if (reject_per_run_settings(conf, "a sweep") != 0) {
+    return -1;
+  }
+
+///conf+sweep_threads+usage `sweep_threads = ` $n$
+///conf+sweep_threads+details Number of threads that play the points of the `[sweep]` grid in parallel.
+///conf+sweep_threads+details Each thread plays one point at a time and takes the next one when it finishes.
+///conf+sweep_threads+default The number of available cores.
+///conf+sweep_threads+example sweep_threads = 4
+  unsigned int n_threads = std::thread::hardware_concurrency();
+  conf.set(&n_threads, {"sweep_threads"});
+
+///conf+sweep_format+usage `sweep_format = ` { `yaml` | `tsv` }
+///conf+sweep_format+details Format of the table with one row per point of the `[sweep]` grid, written
+///conf+sweep_format+details where the `report` would have gone.
+///conf+sweep_format+details With `yaml` it is a list whose items are the swept settings followed by the report of the point.
+///conf+sweep_format+details With `tsv` it is a tab-separated table with a header, ready for plotting tools.
+///conf+sweep_format+default `yaml`
+///conf+sweep_format+example sweep_format = tsv
+  std::string format = "yaml";
+  conf.set(format, {"sweep_format"});
+  if (format != "yaml" && format != "tsv") {
+    std::cerr << "error: sweep_format has to be either yaml or tsv" << std::endl;
+    return -1;
+  }
+
+///conf+sweep_seeds+usage `sweep_seeds = ` { `same` | `different` }
+///conf+sweep_seeds+details With `same`, all the points of the `[sweep]` grid use the same `rng_seed`
+///conf+sweep_seeds+details (a random one if it is not given) so the differences between points are paired
+///conf+sweep_seeds+details comparisons with common random numbers.
+///conf+sweep_seeds+details With `different`, each point draws its own cards. If `rng_seed` is given,
+///conf+sweep_seeds+details each point gets an independent stream derived from it so the grid is still reproducible.
+///conf+sweep_seeds+default `different`
+///conf+sweep_seeds+example sweep_seeds = same
+  std::string seeds = "different";
+  conf.set(seeds, {"sweep_seeds"});
+  if (seeds != "same" && seeds != "different") {
+    std::cerr << "error: sweep_seeds has to be either same or different" << std::endl;
+    return -1;
+  }
+  if (seeds == "same" && conf.exists("rng_seed") == false && conf.exists("seed") == false) {
+    // (it goes through stoi)
+    conf.put("rng_seed", std::to_string(std::random_device()() >> 1));
+    conf.markUsed("rng_seed");
+  }
+
+  std::string report_file_path;
+  conf.set(report_file_path, {"report", "report_file", "report_file_path"});
+
+  // the grid, the last axis runs the fastest
+  std::vector<std::vector<std::string>> points(1);
+  for (auto &axis : conf.sweep) {
+    std::vector<std::vector<std::string>> expanded;
+    for (auto &point : points) {
+      for (auto &value : axis.second) {
+        expanded.push_back(point);
+        expanded.back().push_back(value);
+      }
+    }
+    points.swap(expanded);
+  }
+
+  auto configuration = [&conf](const std::vector<std::string> &point) {
+    Configuration c(conf);
+    size_t j = 0;
+    for (auto &axis : conf.sweep) {
+      c.put(axis.first, point[j++]);
+    }
+    return c;
+  };
+
+  // the first point tells if there are unknown settings and if the player depends on the swept ones,
+  // if it does not (and it keeps no state from round to round) then each thread parses the strategy
+  // only once and reuses its player
+  bool reuse_player = true;
+  {
+    Configuration c = configuration(points[0]);
+    Blackjack dealer(c);
+    Basic player(c);
+    if (c.checkUsed() != 0) {
+      return -1;
+    }
+    Configuration p = configuration(points[0]);
+    Basic probe(p);
+    reuse_player = (probe.stateful() == false);
+    for (auto &axis : conf.sweep) {
+      reuse_player &= (p.isUsed(axis.first) == false);
+    }
+  }
+
+  std::vector<std::list<reportItem>> results(points.size());
+  std::atomic<size_t> next(0);
+  std::atomic<int> error(0);
+  auto worker = [&]() {
+    std::unique_ptr<Player> player;
+    size_t i;
+    while (error == 0 && (i = next++) < points.size()) {
+      Configuration c = configuration(points[i]);
+      Blackjack dealer(c);
+      if (!player || reuse_player == false) {
+        player.reset(new Basic(c));
+      }
+      player->rules = dealer.rules();
+      player->actionRequired = PlayerActionRequired::None;
+      player->actionTaken = PlayerActionTaken::None;
+      dealer.setPlayer(player.get());
+      if (seeds == "different") {
+        dealer.reseed(i);
+      }
+
+      size_t n_incorrect_commands = 0;
+      dealer.nextAction = DealerAction::StartNewHand;
+      while (!dealer.finished()) {
+        dealer.deal();
+        if (player->actionRequired != PlayerActionRequired::None) {
+          n_incorrect_commands = 0;
+          do {
+            if (n_incorrect_commands++ > conf.max_incorrect_commands) {
+              std::cerr << "error: too many unknown commands in point " << i << " of the sweep" << std::endl;
+              error = 1;
+              return;
+            }
+            player->play();
+          } while (dealer.process() <= 0);
+        }
+      }
+
+      // the swept settings go first in the table, so the report cannot repeat them (e.g. rules)
+      dealer.prepareReport(false);
+      results[i] = dealer.reportItems();
+      for (auto &axis : conf.sweep) {
+        results[i].remove_if([&axis](const reportItem &item) { return item.key == axis.first; });
+      }
+    }
+  };
+
+  n_threads = (n_threads == 0) ? 1 : n_threads;
+  n_threads = (n_threads > points.size()) ? points.size() : n_threads;
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < n_threads; t++) {
+    threads.emplace_back(worker);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (error != 0) {
+    return -1;
+  }
+
+  std::ostream* out = &std::cerr;
+  std::ofstream file_stream;
+  if (report_file_path == "stdout") {
+    out = &std::cout;
+  } else if (report_file_path.empty() == false && report_file_path != "stderr") {
+    file_stream.open(report_file_path);
+    if (!file_stream.is_open()) {
+      std::cerr << "error: could not open file " << report_file_path << std::endl;
+      return -1;
+    }
+    out = &file_stream;
+  }
+
+  if (format == "tsv") {
+    const char *separator = "";
+    for (auto &axis : conf.sweep) {
+      *out << separator << axis.first;
+      separator = "\t";
+    }
+    for (auto &item : results[0]) {
+      *out << "\t" << item.key;
+    }
+    *out << std::endl;
+    for (size_t i = 0; i < points.size(); i++) {
+      separator = "";
+      for (auto &value : points[i]) {
+        *out << separator << value;
+        separator = "\t";
+      }
+      for (auto &item : results[i]) {
+        *out << "\t" << report_value(item, false);
+      }
+      *out << std::endl;
+    }
+  } else {
+    *out << "---" << std::endl;
+    for (size_t i = 0; i < points.size(); i++) {
+      const char *indent = "- ";
+      size_t j = 0;
+      for (auto &axis : conf.sweep) {
+        *out << indent << axis.first << ": " << yaml_value(points[i][j++]) << std::endl;
+        indent = "  ";
+      }
+      for (auto &item : results[i]) {
+        *out << "  " << item.key << ": " << report_value(item, true) << std::endl;
+      }
+    }
+    *out << "..." << std::endl;
+  }
+
+  return 0;
+}
+}
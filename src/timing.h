@@ -0,0 +1,176 @@
+/*------------ -------------- -------- --- ----- ---   --       -            -
+ *  Libre Blackjack - sampled per-phase timing
+ *
+ *  Copyright (C) 2025 jeremy theler
+ *
+ *  This file is part of Libre Blackjack.
+ *
+ *  Libre Blackjack is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Libre Blackjack is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Libre Blackjack.  If not, see <http://www.gnu.org/licenses/>.
+ *------------------- ------------  ----    --------  --     -       -         -
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <cstdint>
+#include <time.h>
+
+namespace lbj {
+
+  enum class Phase {
+    Shuffle,
+    Draw,
+    Play,
+    Settlement,
+    Count
+  };
+
+class ScopedPhase;
+
+// nanoseconds spent in each phase, only measured every now and then
+// (except shuffling, which is rare and expensive enough to be always measured)
+// the phases are exclusive, i.e. a phase that starts inside another one (like drawing a card
+// while settling or shuffling while drawing) pauses the outer one, so they add up
+class Timing {
+  public:
+    static inline uint64_t now(void) {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+
+    static inline double cpu(void) {
+      struct timespec ts;
+      clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+      return ts.tv_sec + 1e-9 * ts.tv_nsec;
+    }
+
+    // called once per hand, it decides whether this hand is sampled or not
+    inline void newHand(void) {
+      if (--countdown == 0) {
+        countdown = every;
+        sampling = true;
+        sampled_hands++;
+      } else {
+        sampling = false;
+      }
+    }
+
+    unsigned int every = 64;
+    unsigned int countdown = 64;
+    bool sampling = false;
+    size_t sampled_hands = 0;
+    uint64_t ns[static_cast<int>(Phase::Count)] = {0};
+    uint64_t calls[static_cast<int>(Phase::Count)] = {0};
+    ScopedPhase *current = nullptr;   // innermost phase being measured
+};
+
+// log-linear histogram of nanoseconds with eight buckets per power of two,
+// good enough for quantiles within about ten percent without keeping samples
+class Histogram {
+  public:
+    static const int sub = 8;
+    static const int buckets = 62 * sub;
+
+    inline void add(uint64_t ns) {
+      counts[index(ns)]++;
+      n++;
+      if (ns > max) {
+        max = ns;
+      }
+    }
+
+    // upper edge of the bucket holding the q-th quantile (but never above the maximum)
+    uint64_t quantile(double q) const {
+      uint64_t rank = static_cast<uint64_t>(q * n + 0.5);
+      rank = (rank < 1) ? 1 : rank;
+      uint64_t seen = 0;
+      for (int i = 0; i < buckets; i++) {
+        if ((seen += counts[i]) >= rank) {
+          uint64_t edge = upper(i);
+          return (edge < max) ? edge : max;
+        }
+      }
+      return max;
+    }
+
+    uint64_t n = 0;
+    uint64_t max = 0;
+    uint64_t counts[buckets] = {0};
+
+  private:
+    static inline int index(uint64_t ns) {
+      if (ns < 2 * sub) {
+        return static_cast<int>(ns);
+      }
+      int msb = 63 - __builtin_clzll(ns);
+      return (msb - 2) * sub + static_cast<int>((ns >> (msb - 3)) & (sub - 1));
+    }
+
+    static inline uint64_t upper(int i) {
+      if (i < 2 * sub) {
+        return i + 1;
+      }
+      int shift = i / sub - 1;
+      return (static_cast<uint64_t>(sub + i % sub + 1)) << shift;
+    }
+};
+
+class ScopedPhase {
+  public:
+    ScopedPhase(Timing &t, Phase p, bool always = false) : timing(t), phase(static_cast<int>(p)), active(always || t.sampling) {
+      if (active) {
+        start = Timing::now();
+        // pause the enclosing phase
+        if ((outer = timing.current) != nullptr) {
+          timing.ns[outer->phase] += start - outer->start;
+        }
+        timing.current = this;
+      }
+    }
+    ~ScopedPhase() {
+      if (active) {
+        uint64_t end = Timing::now();
+        timing.ns[phase] += end - start;
+        timing.calls[phase]++;
+        // and resume it
+        if ((timing.current = outer) != nullptr) {
+          outer->start = end;
+        }
+      }
+    }
+
+  private:
+    Timing &timing;
+    int phase;
+    bool active;
+    uint64_t start = 0;
+    ScopedPhase *outer = nullptr;
+};
+}
+
+// configure --disable-timing removes every trace of the instrumentation
+#ifdef TIMING
+#define LBJ_TIMING_CONCAT2(a, b) a##b
+#define LBJ_TIMING_CONCAT(a, b) LBJ_TIMING_CONCAT2(a, b)
+#define LBJ_TIME_PHASE(timing, phase)        lbj::ScopedPhase LBJ_TIMING_CONCAT(scoped_phase_, __LINE__)(timing, phase)
+#define LBJ_TIME_PHASE_ALWAYS(timing, phase) lbj::ScopedPhase LBJ_TIMING_CONCAT(scoped_phase_, __LINE__)(timing, phase, true)
+#define LBJ_TIME_NEW_HAND(timing)            (timing).newHand()
+#else
+#define LBJ_TIME_PHASE(timing, phase)
+#define LBJ_TIME_PHASE_ALWAYS(timing, phase)
+#define LBJ_TIME_NEW_HAND(timing)
+#endif
+
+#endif
@@ -43,6 +43,10 @@ void shortversion(void) {
 
 void help(const char *program_name) {
   std::cout << "usage: " << program_name <<  " [options] [-c path_to_conf_file]" << std::endl;
+  std::cout << "       " << program_name <<  " merge [options] [-c path_to_conf_file] raw_report1 raw_report2 ..." << std::endl;
+  std::cout << "       " << program_name <<  " eor [options] [-c path_to_conf_file]" << std::endl;
+  std::cout << "       " << program_name <<  " counts [options] [-c path_to_conf_file]" << std::endl;
+  std::cout << "       " << program_name <<  " indices [options] [-c path_to_conf_file]" << std::endl;
   std::cout << ENGINE << std::endl;
 
   std::cout << std::endl;
@@ -81,6 +85,12 @@ void help(const char *program_name) {
   std::cout << "If no configuration file is given, a file named blackjack.conf" << std::endl;
   std::cout << "in the current directory is used, provided it exists." << std::endl;
   std::cout << "See the full documentation for the available options and the default values." << std::endl;
+  std::cout << "The merge subcommand combines the raw_report files of several runs (e.g. shards)" << std::endl;
+  std::cout << "into a single report." << std::endl;
+  std::cout << "The eor subcommand computes the effect of removal of each rank off the top" << std::endl;
+  std::cout << "of the shoe and the weights of the linear count that follow from them." << std::endl;
+  std::cout << "The counts subcommand compares several card-counting systems on the same cards." << std::endl;
+  std::cout << "The indices subcommand finds the counts at which index plays change the basic strategy." << std::endl;
 
   return;
 }
@@ -0,0 +1,44 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh 
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+# same as blackjack but counting calls to malloc and operator new
+alloc=$(dirname ${blackjack})/blackjack-alloc
+if [ ! -x ${alloc} ]; then
+  echo "blackjack-alloc not found, skipping test"
+  exit 77
+fi
+
+# the internal player should not allocate anything once warmed up
+n=2e5
+for d in 0 6; do
+  echo "internal player ${d}decks"
+  $alloc -i --report=alloc-internal.yaml --report_verbosity=6 -n${n} --decks=${d}
+  per_hand=$(yq .allocations_per_hand alloc-internal.yaml)
+  echo " ${per_hand} allocations per hand"
+  awk -v a="${per_hand}" 'BEGIN { exit !(a == 0) }'
+  exitifwrong $?
+done
+
+# the other players are just reported
+n=5e4
+echo "stdinout player"
+yes stand | $alloc --report=alloc-stdinout.yaml --report_verbosity=6 -n${n} --flat_bet=true --no_insurance=true > /dev/null
+echo " $(yq .allocations_per_hand alloc-stdinout.yaml) allocations per hand"
+
+echo "stdinout player (verbose)"
+yes stand | $alloc --report=alloc-stdinout.yaml --report_verbosity=6 -n${n} --flat_bet=true --no_insurance=true --verbose=true > /dev/null
+echo " $(yq .allocations_per_hand alloc-stdinout.yaml) allocations per hand"
+
+# the tty player needs a terminal so it cannot be run here
+
+echo "ok"
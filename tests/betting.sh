@@ -0,0 +1,83 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+n=200000
+
+# a martingale capped by the table maximum keeps the mean and the bankroll consistent,
+# and it starts over when the next bet would be over the maximum (i.e. after six losses from 1 to 64)
+echo "martingale up to the table maximum"
+$blackjack -i -n${n} --rng_seed=7 --betting_system=martingale --max_bet=64 --report_verbosity=4 --report=betting.yaml
+exitifwrong $?
+mean=$(yq .mean betting.yaml)
+bankroll=$(yq .bankroll betting.yaml)
+waged=$(yq .total_money_waged betting.yaml)
+capped=$(yq .capped_bets betting.yaml)
+longest=$(yq .longest_progression betting.yaml)
+dropped=$(yq .dropped_progressions betting.yaml)
+echo " mean ${mean}, bankroll ${bankroll}, waged ${waged}, ${dropped} dropped progressions, ${longest} losses in a row"
+awk -v m="${mean}" -v b="${bankroll}" -v n="${n}" -v w="${waged}" -v d="${dropped}" -v l="${longest}" \
+    'BEGIN { x = m - b/n; exit !(x*x < 1e-10 && w > 1.5*n && d > 0 && l == 6) }'
+exitifwrong $?
+
+# with no goal and no limit on the rounds every session ends in ruin
+echo "sessions with a small bankroll"
+$blackjack -i -n${n} --rng_seed=7 --betting_system=fibonacci --session_bankroll=50 --report_verbosity=3 --report=betting.yaml
+exitifwrong $?
+sessions=$(yq .sessions betting.yaml)
+ruined=$(yq .ruined_sessions betting.yaml)
+echo " ${ruined} out of ${sessions} sessions ruined"
+awk -v s="${sessions}" -v r="${ruined}" 'BEGIN { exit !(s > 10 && s == r) }'
+exitifwrong $?
+
+# the player never has more on the table than what is left of the session bankroll, so it never goes below zero
+# (it does not double nor split nor insure if it cannot cover it)
+echo "stakes within the bankroll"
+$blackjack --player=counter -d6 -n${n} --rng_seed=7 --betting_system=martingale --deviations="ins A 3 y" \
+           --session_bankroll=20 --report_verbosity=3 --report=betting.yaml
+exitifwrong $?
+lowest=$(yq .lowest_bankroll betting.yaml)
+sessions=$(yq .sessions betting.yaml)
+echo " lowest bankroll ${lowest} in ${sessions} sessions"
+awk -v l="${lowest}" -v s="${sessions}" 'BEGIN { exit !(s > 10 && l >= 0) }'
+exitifwrong $?
+
+# nobody bets less than the table minimum
+echo "table minimum"
+$blackjack -i -n${n} --rng_seed=7 --minimum_bet=5 --report_verbosity=4 --report=betting.yaml
+exitifwrong $?
+waged=$(yq .total_money_waged betting.yaml)
+echo " waged ${waged}"
+awk -v n="${n}" -v w="${waged}" 'BEGIN { exit !(w >= 5*n) }'
+exitifwrong $?
+
+# kelly with a positive count bets more than the minimum
+echo "kelly with the counter"
+$blackjack --player=counter -d6 -n${n} --rng_seed=7 --betting_system=kelly --session_bankroll=10000 --report_verbosity=4 --report=betting.yaml
+exitifwrong $?
+waged=$(yq .total_money_waged betting.yaml)
+echo " waged ${waged}"
+awk -v n="${n}" -v w="${waged}" 'BEGIN { exit !(w > 2*n) }'
+exitifwrong $?
+
+# kelly needs to know the bankroll
+if $blackjack -i -n1000 --betting_system=kelly --report=/dev/null 2> /dev/null; then
+  exit 1
+fi
+
+# a session has to be able to pay for at least one bet at the table minimum
+if $blackjack -i -n1000 --minimum_bet=5 --session_bankroll=4 --report=/dev/null 2> /dev/null; then
+  exit 1
+fi
+
+rm -f betting.yaml
+echo "ok"
@@ -0,0 +1,110 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+n=100000
+m=300000
+rm -rf cache-a cache-b
+mkdir cache-a cache-b
+
+# the seed is not part of the signature, so two caches that start with different seeds
+# and are topped up with the same one play the very same m-n hands on top
+echo "top-up from ${n} to ${m} hands"
+$blackjack -i -n${n} --rng_seed=1 --results_cache=cache-a --report=cache-a1.yaml
+exitifwrong $?
+cp cache-a/*.yaml cache-a.yaml
+$blackjack -i -n${m} --rng_seed=3 --results_cache=cache-a --report=cache-a2.yaml
+exitifwrong $?
+$blackjack -i -n${n} --rng_seed=2 --results_cache=cache-b --report=cache-b1.yaml
+exitifwrong $?
+cp cache-b/*.yaml cache-b.yaml
+$blackjack -i -n${m} --rng_seed=3 --results_cache=cache-b --report=cache-b2.yaml
+exitifwrong $?
+
+for i in a b; do
+  hands=$(yq .hands cache-${i}2.yaml)
+  cached=$(yq .hands_cached cache-${i}2.yaml)
+  echo " ${i}: ${hands} hands, ${cached} cached"
+  if [ "x${hands}" != "x${m}" ] || [ "x${cached}" != "x${n}" ]; then
+    exit 1
+  fi
+done
+
+# the top-up is what the merged accumulators have on top of the cached ones (Chan et al backwards),
+# it has to be the same in both caches and the report has to show the merged mean and error
+top_up() {
+  awk -v n1="$(yq .hands cache-${1}.yaml)" -v m1="$(yq .mean cache-${1}.yaml)" -v s1="$(yq .M2 cache-${1}.yaml)" \
+      -v n2="$(yq .hands cache-${1}/*.yaml)" -v m2="$(yq .mean cache-${1}/*.yaml)" -v s2="$(yq .M2 cache-${1}/*.yaml)" \
+      -v mean="$(yq .mean cache-${1}2.yaml)" -v error="$(yq .error cache-${1}2.yaml)" \
+      'BEGIN { n = n2 - n1; x = (n2*m2 - n1*m1)/n; d = x - m1;
+               e = 3*sqrt(s2/(n2-1)/n2) - error; r = mean - m2;
+               if (e*e > 1e-12 || r*r > 1e-12) { print "wrong"; exit }
+               printf("%d %.10f %.6f\n", n, x, s2 - s1 - d*d*n1*n/n2) }'
+}
+a=$(top_up a)
+b=$(top_up b)
+echo " top-up a: ${a}"
+echo " top-up b: ${b}"
+if [ "x${a}" != "x${b}" ] || [ "x${a}" = "xwrong" ]; then
+  exit 1
+fi
+if [ "$(echo ${a} | cut -d' ' -f1)" != "$((m - n))" ]; then
+  exit 1
+fi
+
+# asking again for what is already there plays nothing
+echo "nothing to top up"
+$blackjack -i -n${m} --rng_seed=4 --results_cache=cache-a --report=cache-a3.yaml
+exitifwrong $?
+if [ "$(yq .mean cache-a3.yaml)" != "$(yq .mean cache-a2.yaml)" ] || [ "$(yq .hands cache-a3.yaml)" != "${m}" ]; then
+  exit 1
+fi
+
+# two runs at the same time on the same cache do not lose each other's hands, the second one
+# waits for the first and then tops up what it left (if anything)
+echo "concurrent runs"
+rm -rf cache-a
+mkdir cache-a
+$blackjack -i -n2e6 --rng_seed=1 --results_cache=cache-a --report=cache-a1.yaml 2> /dev/null &
+$blackjack -i -n4e6 --rng_seed=2 --results_cache=cache-a --report=cache-a2.yaml 2> /dev/null &
+wait
+hands=$(yq .hands cache-a/*.yaml)
+bankroll=$(yq .bankroll cache-a/*.yaml)
+echo " ${hands} hands, bankroll ${bankroll}"
+if [ "x${hands}" != "x4000000" ]; then
+  exit 1
+fi
+# the one that went last has the whole cache in its report
+last=0
+for i in 1 2; do
+  if [ "$(yq .hands_cached cache-a${i}.yaml)" != "null" ]; then
+    last=${i}
+  fi
+done
+if [ ${last} = 0 ] || [ "$(yq .hands cache-a${last}.yaml)" != "${hands}" ] || [ "$(yq .bankroll cache-a${last}.yaml)" != "${bankroll}" ]; then
+  exit 1
+fi
+
+# quitting when the arranged cards run out changes how many hands are played, so it is another entry
+echo "quit_when_arranged_cards_run_out"
+rm -rf cache-a
+mkdir cache-a
+$blackjack -i -n1000 --cards="A 9 10 8" --results_cache=cache-a --report=/dev/null
+exitifwrong $?
+$blackjack -i -n1000 --cards="A 9 10 8" --quit_when_arranged_cards_run_out=true --results_cache=cache-a --report=/dev/null
+exitifwrong $?
+if [ "$(ls cache-a/*.yaml | wc -l)" != "2" ]; then
+  exit 1
+fi
+
+rm -rf cache-a cache-b cache-a.yaml cache-b.yaml cache-a1.yaml cache-a2.yaml cache-a3.yaml cache-b1.yaml cache-b2.yaml
+echo "ok"
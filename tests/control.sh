@@ -0,0 +1,113 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+# we need something that talks to unix-domain sockets
+if [ -n "$(which socat)" ]; then
+  ask() {
+    echo "${1}" | socat - UNIX-CONNECT:control.sock
+  }
+elif [ -n "$(which python3)" ]; then
+  ask() {
+    python3 -c 'import socket, sys
+s = socket.socket(socket.AF_UNIX)
+s.connect(sys.argv[1])
+s.sendall((sys.argv[2] + "\n").encode())
+s.shutdown(socket.SHUT_WR)
+sys.stdout.write(s.makefile().read())' control.sock "${1}"
+  }
+else
+  echo "neither socat nor python3 found, skipping test"
+  exit 77
+fi
+
+# the status is published every thousand hands or so (and every 50 ms while paused)
+status() {
+  ask status | yq .${1}
+}
+
+rm -f control.sock control-interim.yaml control.yaml
+$blackjack -i -n1e12 --rng_seed=1 --control_socket=control.sock --interim_report=control-interim.yaml --report=control.yaml &
+pid=$!
+for t in 1 2 3 4 5 6 7 8 9 10; do
+  if [ ! -S control.sock ]; then
+    sleep 0.5
+  fi
+done
+sleep 0.5
+
+echo "status"
+total=$(status hands_total)
+paused=$(status paused)
+echo " ${total} hands to play, paused ${paused}"
+if [ "x${total}" != "x1000000000000" ] || [ "x${paused}" != "xfalse" ]; then
+  exit 1
+fi
+
+# a paused run does not play and still answers
+echo "pause"
+if [ "$(ask pause | yq .ok)" != "true" ]; then
+  exit 1
+fi
+sleep 0.5
+paused=$(status paused)
+before=$(status hands)
+sleep 0.5
+after=$(status hands)
+echo " paused ${paused} at ${before} and ${after} hands"
+if [ "x${paused}" != "xtrue" ] || [ "x${before}" != "x${after}" ]; then
+  exit 1
+fi
+
+echo "extend and checkpoint"
+ask "extend 1000" > /dev/null
+ask checkpoint > /dev/null
+sleep 0.5
+total=$(status hands_total)
+interim=$(yq .hands control-interim.yaml)
+echo " ${total} hands to play, ${interim} in the interim report"
+awk -v t="${total}" -v i="${interim}" -v h="${after}" 'BEGIN { d = i - h; exit !(t == 1000000001000 && d*d <= 1) }'
+exitifwrong $?
+
+echo "unknown commands"
+if [ "$(ask dance | yq .ok)" != "false" ] || [ "$(ask "extend -1" | yq .ok)" != "false" ]; then
+  exit 1
+fi
+
+echo "resume"
+ask resume > /dev/null
+sleep 1
+resumed=$(status hands)
+echo " ${resumed} hands"
+if [ "x$(status paused)" != "xfalse" ] || [ ${resumed} -le ${after} ]; then
+  exit 1
+fi
+
+# quit finishes the current hand and writes the final report, with flat bets the mean is the bankroll over the hands
+echo "quit"
+ask quit > /dev/null
+wait ${pid}
+exitifwrong $?
+hands=$(yq .hands control.yaml)
+mean=$(yq .mean control.yaml)
+bankroll=$(yq .bankroll control.yaml)
+echo " ${hands} hands, mean ${mean}, bankroll ${bankroll}"
+awk -v r="${resumed}" -v n="${hands}" -v m="${mean}" -v b="${bankroll}" \
+    'BEGIN { d = m - b/n; exit !(n >= r && n < 1e12 && d*d < 1e-14) }'
+exitifwrong $?
+if [ -e control.sock ]; then
+  echo "the socket is still there"
+  exit 1
+fi
+
+rm -f control-interim.yaml control.yaml
+echo "ok"
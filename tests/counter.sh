@@ -0,0 +1,81 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+n=200000
+
+# without a ramp nor deviations the counter plays exactly like the internal player
+echo "counter without ramp nor deviations"
+$blackjack -i -d6 -n${n} --rng_seed=5 --report=internal.yaml
+exitifwrong $?
+$blackjack --player=counter -d6 -n${n} --rng_seed=5 --report=counter.yaml
+exitifwrong $?
+internal=$(yq .bankroll internal.yaml)
+counter=$(yq .bankroll counter.yaml)
+echo " bankroll ${internal} and ${counter}"
+if [ "x${internal}" != "x${counter}" ]; then
+  exit 1
+fi
+
+# with a ramp the bets change, and insuring at high counts keeps the mean and the bankroll consistent
+echo "counter with ramp and deviations"
+$blackjack --player=counter -d6 -n${n} --rng_seed=5 --bet_ramp="1:2 2:4 3:8" \
+           --deviations="ins A 3 y, h16 T 0 s, h12 3 2 s" --report_verbosity=4 --report=counter.yaml
+exitifwrong $?
+mean=$(yq .mean counter.yaml)
+bankroll=$(yq .bankroll counter.yaml)
+waged=$(yq .total_money_waged counter.yaml)
+taken=$(yq .deviations_taken counter.yaml)
+echo " mean ${mean}, bankroll ${bankroll}, waged ${waged}, ${taken} deviations taken"
+awk -v m="${mean}" -v b="${bankroll}" -v n="${n}" -v w="${waged}" -v t="${taken}" \
+    'BEGIN { d = m - b/n; exit !(d*d < 1e-10 && w > 1.5*n && t > 0) }'
+exitifwrong $?
+
+# running out of cards in the middle of a round is a shuffle too, counters are told about every one
+# (but the very first, which happens before there is anybody at the table)
+echo "shuffles in the middle of a round"
+yes stand | $blackjack -d1 --penetration=1 -n2000 --flat_bet=true --no_insurance=true --verbose=true --rng_seed=1 \
+                       --report_verbosity=6 --report=counter.yaml > counter.txt
+exitifwrong $?
+told=$(grep -c "^shuffling" counter.txt)
+shuffles=$(yq .shuffles counter.yaml)
+echo " ${told} out of ${shuffles} shuffles"
+if [ $((told + 1)) -ne ${shuffles} ]; then
+  exit 1
+fi
+
+# not splitting at an index plays the pair as a regular hand, the same as a strategy that never splits it
+echo "do not split at an index"
+echo "p8  n  n  n  n  n  n  n  n  n  n" > counter-strategy.txt
+$blackjack -i -d6 -n${n} --rng_seed=5 --strategy_file=counter-strategy.txt --report=internal.yaml
+exitifwrong $?
+$blackjack --player=counter -d6 -n${n} --rng_seed=5 --report_verbosity=3 --report=counter.yaml \
+           --deviations="p8 2 -1000 n, p8 3 -1000 n, p8 4 -1000 n, p8 5 -1000 n, p8 6 -1000 n, p8 7 -1000 n, p8 8 -1000 n, p8 9 -1000 n, p8 T -1000 n, p8 A -1000 n"
+exitifwrong $?
+internal=$(yq .bankroll internal.yaml)
+counter=$(yq .bankroll counter.yaml)
+taken=$(yq .deviations_taken counter.yaml)
+echo " bankroll ${internal} and ${counter}, ${taken} deviations taken"
+if [ "x${internal}" != "x${counter}" ] || [ ${taken} -eq 0 ]; then
+  exit 1
+fi
+
+# typos in the index plays are errors, and so are actions that do not belong to the hand
+for deviation in "h16 X 0 s" "h16 T 0 y" "s18 6 1 n" "p8 T 0 s" "ins A 3 d"; do
+  if $blackjack --player=counter -n1000 --deviations="${deviation}" --report=/dev/null 2> /dev/null; then
+    echo "'${deviation}' was accepted"
+    exit 1
+  fi
+done
+
+rm -f internal.yaml counter.yaml counter.txt counter-strategy.txt
+echo "ok"
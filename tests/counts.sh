@@ -0,0 +1,56 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+n=300000
+echo "hi-lo and its opposite side by side"
+$blackjack counts -d6 -n${n} --rng_seed=2 --count_systems="hi-lo, 1 -1 -1 -1 -1 -1 0 0 0 1" --report=counts.yaml
+exitifwrong $?
+
+for i in 0 1; do
+  echo " $(yq ".systems[${i}].betting_correlation" counts.yaml) $(yq ".systems[${i}].stiff_bust_correlation" counts.yaml) $(yq ".systems[${i}].insurance_correlation" counts.yaml)"
+done
+
+# hi-lo tracks the player's edge, the stiffs' bust chances and the tens, and the opposite does the opposite
+for what in betting_correlation stiff_bust_correlation insurance_correlation; do
+  awk -v a="$(yq .systems[0].${what} counts.yaml)" -v b="$(yq .systems[1].${what} counts.yaml)" \
+      'BEGIN { d = a + b; exit !(a > 0.5 && d*d < 1e-10) }'
+  exitifwrong $?
+done
+
+# unbalanced counts go into the correlations per deck left, like the balanced ones, so ko is about as good as hi-lo
+echo "hi-lo and ko"
+$blackjack counts -d6 -n${n} --rng_seed=2 --count_systems="hi-lo, ko" --report=ko.yaml
+exitifwrong $?
+hilo=$(yq .systems[0].betting_correlation ko.yaml)
+ko=$(yq .systems[1].betting_correlation ko.yaml)
+echo " ${hilo} ${ko}"
+awk -v a="${hilo}" -v b="${ko}" 'BEGIN { exit !(b > 0.8 && (a - b)^2 < 0.01) }'
+exitifwrong $?
+
+# every round is in one (and only one) bin of each system
+sum=$(yq '.systems[1].ev_by_count[].hands' counts.yaml | awk '{ s += $1 } END { print s }')
+echo " ${sum} hands in the bins"
+if [ "x${sum}" != "x$(yq .hands counts.yaml)" ]; then
+  exit 1
+fi
+
+# unknown systems and infinite shoes are errors
+if $blackjack counts -d6 -n1000 --count_systems="hi-lo, foo" --report=/dev/null 2> /dev/null; then
+  exit 1
+fi
+if $blackjack counts -d0 -n1000 --report=/dev/null 2> /dev/null; then
+  exit 1
+fi
+
+rm -f counts.yaml ko.yaml
+echo "ok"
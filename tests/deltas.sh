@@ -0,0 +1,65 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+cat > deltas.conf << EOF2
+hands = 100000
+decks = 6
+[deltas]
+rules = h17
+blackjack_pays = 1.2
+rules = s17
+EOF2
+
+$blackjack -c deltas.conf --report=deltas.yaml
+exitifwrong $?
+
+# a change that changes nothing has to give the very same rounds
+echo "no change"
+delta=$(yq '.deltas[0].delta' deltas.yaml)
+error=$(yq '.deltas[0].error' deltas.yaml)
+echo " delta ${delta} ± ${error}"
+if [ "x${delta}" != "x0" ] || [ "x${error}" != "x0" ]; then
+  exit 1
+fi
+
+# 6:5 costs three tenths of a unit for each player's blackjack that is not pushed (about 0.0452 per hand)
+echo "blackjack pays 6:5"
+delta=$(yq '.deltas[1].delta' deltas.yaml)
+error=$(yq '.deltas[1].error' deltas.yaml)
+unpaired=$(yq '.deltas[1].unpaired_error' deltas.yaml)
+echo " delta ${delta} ± ${error} (${unpaired} if unpaired)"
+awk -v d="${delta}" -v e="${error}" 'BEGIN { exit !((d + 0.01357)^2 < e^2) }'
+exitifwrong $?
+
+# pairing the rounds is what makes this worth it
+echo "s17"
+error=$(yq '.deltas[2].error' deltas.yaml)
+unpaired=$(yq '.deltas[2].unpaired_error' deltas.yaml)
+echo " $(yq '.deltas[2].delta' deltas.yaml) ± ${error} (${unpaired} if unpaired)"
+awk -v e="${error}" -v u="${unpaired}" 'BEGIN { exit !(5 * e < u) }'
+exitifwrong $?
+
+# the shoe is the base one for everybody, so changing it is an error and not a zero delta
+echo "shoe settings"
+cat > deltas.conf << EOF2
+hands = 1000
+decks = 6
+[deltas]
+decks = 1
+EOF2
+if $blackjack -c deltas.conf --report=deltas.yaml 2> /dev/null; then
+  exit 1
+fi
+
+rm -f deltas.conf deltas.yaml
+echo "ok"
@@ -0,0 +1,48 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+n=1000000
+echo "edge by true count and depth for ${n} hands"
+$blackjack -i -d6 -n${n} --rng_seed=4 --report=plain.yaml
+exitifwrong $?
+$blackjack -i -d6 -n${n} --rng_seed=4 --edge_profile --report=profile.yaml
+exitifwrong $?
+
+# profiling does not change the game
+if [ "x$(yq .bankroll plain.yaml)" != "x$(yq .bankroll profile.yaml)" ]; then
+  exit 1
+fi
+
+# every round is in one bin, and the bins add up to the mean
+hands=$(yq '[.edge_profile[].hands] | add' profile.yaml)
+frequency=$(yq '[.edge_profile[].frequency] | add' profile.yaml)
+mean=$(yq '[.edge_profile[] | .mean * .hands] | add' profile.yaml)
+echo " ${hands} hands in the bins, mean $(yq .mean profile.yaml)"
+awk -v h="${hands}" -v n="${n}" -v f="${frequency}" -v s="${mean}" -v m="$(yq .mean profile.yaml)" \
+    'BEGIN { d = s/n - m; exit !(h == n && (f-1)*(f-1) < 1e-10 && d*d < 1e-10) }'
+exitifwrong $?
+
+# the player is better off with high counts than with low counts
+high=$(yq '[.edge_profile[] | select(.count >= 2)] | (map(.mean * .hands) | add) / (map(.hands) | add)' profile.yaml)
+low=$(yq '[.edge_profile[] | select(.count <= -2)] | (map(.mean * .hands) | add) / (map(.hands) | add)' profile.yaml)
+echo " ${low} at counts of -2 and below, ${high} at 2 and above"
+awk -v h="${high}" -v l="${low}" 'BEGIN { exit !(h > l) }'
+exitifwrong $?
+
+# an infinite shoe has no count
+if $blackjack -i -d0 -n1000 --edge_profile --report=/dev/null 2> /dev/null; then
+  exit 1
+fi
+
+rm -f plain.yaml profile.yaml
+echo "ok"
@@ -0,0 +1,50 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+echo "single-deck effect of removal"
+$blackjack eor -d1 -n300000 --rng_seed=3 --report=eor.yaml
+exitifwrong $?
+
+for i in 0 1 2 3 4 5 6 7 8 9; do
+  echo " $(yq ".eor[${i}].rank" eor.yaml | tr -d '"') $(yq ".eor[${i}].eor" eor.yaml) ± $(yq ".eor[${i}].error" eor.yaml)"
+done
+
+# removing a five helps the player and removing a ten hurts
+five=$(yq '.eor[4].eor' eor.yaml)
+ten=$(yq '.eor[9].eor' eor.yaml)
+awk -v f="${five}" -v t="${ten}" 'BEGIN { exit !(f > 0 && t < 0) }'
+exitifwrong $?
+
+# removing a random card off the top does not change the expected value,
+# so the EORs weighted by how many cards of each rank there are add up to zero
+sum=0
+bound=0
+for i in 0 1 2 3 4 5 6 7 8 9; do
+  n=1
+  if [ ${i} -eq 9 ]; then
+    n=4
+  fi
+  sum=$(awk -v s="${sum}" -v n="${n}" -v e="$(yq ".eor[${i}].eor" eor.yaml)" 'BEGIN { print s + n*e }')
+  bound=$(awk -v s="${bound}" -v n="${n}" -v e="$(yq ".eor[${i}].error" eor.yaml)" 'BEGIN { print s + n*e }')
+done
+echo " weighted sum ${sum} (bound ${bound})"
+awk -v s="${sum}" -v b="${bound}" 'BEGIN { exit !(s*s < b*b) }'
+exitifwrong $?
+
+# the EOR needs a shoe
+if $blackjack eor -d0 -n1000 --report=/dev/null 2> /dev/null; then
+  exit 1
+fi
+
+rm -f eor.yaml
+echo "ok"
@@ -0,0 +1,39 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+echo "insurance and 15 vs ten index plays"
+$blackjack indices -d6 -n2000000 --rng_seed=6 --index_cells="ins A, h15 T, h4 2" --report=indices.txt
+exitifwrong $?
+cat indices.txt
+
+# insure at a positive true count (it is +3 for hi-lo) and never at a negative one
+index=$(awk '$1 == "ins" && $2 == "A" && $4 == "y" { print $3 }' indices.txt)
+if [ -z "${index}" ]; then
+  exit 1
+fi
+awk -v i="${index}" 'BEGIN { exit !(i > 0 && i < 7) }'
+exitifwrong $?
+
+# twos against a two are split, so a hard four (almost) never gets to be played
+grep -q "^# h4 2 not enough decisions" indices.txt
+exitifwrong $?
+
+# the table can be fed back to the counter player
+$blackjack --player=counter -d6 -n10000 --deviations_file=indices.txt --report=/dev/null
+exitifwrong $?
+
+# typos in the cells are errors
+if $blackjack indices -d6 -n1000 --index_cells="h16 X" --report=/dev/null 2> /dev/null; then
+  exit 1
+fi
+
+rm -f indices.txt
+echo "ok"
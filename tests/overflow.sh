@@ -0,0 +1,52 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+# we cannot play 1e11 hands here, so we play a few, make the results
+# cache believe they were 1e11 with counters right at the 32-bit boundary
+# and then play a few more on top of that
+echo "counters past 2^32 hands"
+rm -rf overflow-cache
+mkdir overflow-cache
+$blackjack -i -n1000 --results_cache=overflow-cache --report=overflow.yaml
+exitifwrong $?
+
+cache=$(ls overflow-cache/*.yaml)
+sed -e 's/^hands:.*/hands: 100000000000/' \
+    -e 's/^mean:.*/mean: -0.005/' \
+    -e 's/^M2:.*/M2: 130000000000/' \
+    -e 's/^busts_player:.*/busts_player: 4294967295/' \
+    -e 's/^wins:.*/wins: 43000000000/' \
+    ${cache} > overflow-cache/tmp
+mv overflow-cache/tmp ${cache}
+
+$blackjack -i -n100000001000 --results_cache=overflow-cache --report=overflow.yaml
+exitifwrong $?
+
+hands=$(yq .hands overflow.yaml)
+busts=$(yq .busts_player_n overflow.yaml)
+mean=$(yq .mean overflow.yaml)
+variance=$(yq .variance overflow.yaml)
+echo " ${hands} hands, ${busts} player busts, mean ${mean}, variance ${variance}"
+
+if [ "x${hands}" != "x100000001000" ]; then
+  exit 1
+fi
+# with 32-bit counters the busts would have wrapped around to a few hundreds
+awk -v b="${busts}" 'BEGIN { exit !(b > 4294967295 && b < 4294967295 + 1000) }'
+exitifwrong $?
+# a thousand hands cannot move the mean and the variance of 1e11 ones
+awk -v m="${mean}" -v v="${variance}" 'BEGIN { exit !(m > -0.00501 && m < -0.00499 && v > 1.29 && v < 1.31) }'
+exitifwrong $?
+
+rm -rf overflow-cache
+echo "ok"
@@ -0,0 +1,59 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+# a campaign split into four processes and merged back
+n=100001
+echo "four shards of ${n} hands"
+for i in 0 1 2 3; do
+  $blackjack -i -n${n} --rng_seed=7 --shard=${i}/4 --raw_report=shard-${i}.yaml --report=/dev/null &
+done
+wait
+
+$blackjack merge shard-0.yaml shard-1.yaml shard-2.yaml shard-3.yaml --report=shards.yaml
+exitifwrong $?
+
+hands=$(yq .hands shards.yaml)
+merged=$(yq .merged_reports shards.yaml)
+mean=$(yq .mean shards.yaml)
+bankroll=$(yq .bankroll shards.yaml)
+echo " ${hands} hands from ${merged} reports, mean ${mean}, bankroll ${bankroll}"
+if [ "x${hands}" != "x${n}" ] || [ "x${merged}" != "x4" ]; then
+  exit 1
+fi
+
+# the shards are different slices and they add up (with flat bets the mean is the bankroll over the hands)
+sum=0
+for i in 0 1 2 3; do
+  sum=$(awk -v s="${sum}" -v b="$(yq .bankroll shard-${i}.yaml)" 'BEGIN { print s + b }')
+done
+awk -v s="${sum}" -v b="${bankroll}" -v m="${mean}" -v n="${hands}" 'BEGIN { d = m - b/n; exit !(s == b && d*d < 1e-14) }'
+exitifwrong $?
+if cmp -s shard-0.yaml shard-1.yaml; then
+  echo "shards 0 and 1 are the same"
+  exit 1
+fi
+
+# the same shard is the same slice
+echo "determinism"
+$blackjack -i -n${n} --rng_seed=7 --shard=1/4 --raw_report=shard-again.yaml --report=/dev/null
+cmp shard-1.yaml shard-again.yaml
+exitifwrong $?
+
+# merging a shard twice is an error
+echo "duplicated shards"
+if $blackjack merge shard-0.yaml shard-0.yaml --report=/dev/null 2> /dev/null; then
+  exit 1
+fi
+
+rm -f shard-0.yaml shard-1.yaml shard-2.yaml shard-3.yaml shard-again.yaml
+echo "ok"
@@ -0,0 +1,63 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+# waits up to ten seconds for a complete report
+wait_for_report() {
+  for t in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+    if grep -q '^\.\.\.' ${1} 2> /dev/null; then
+      return 0
+    fi
+    sleep 0.5
+  done
+  return 1
+}
+
+rm -f signals-interim.yaml signals.yaml
+$blackjack -i -n1e12 --rng_seed=1 --interim_report=signals-interim.yaml --report=signals.yaml &
+pid=$!
+sleep 1
+
+# SIGUSR1 writes what was played so far and the run goes on
+echo "interim report"
+kill -USR1 ${pid}
+wait_for_report signals-interim.yaml
+exitifwrong $?
+interim=$(yq .hands signals-interim.yaml)
+echo " ${interim} hands so far"
+if ! kill -0 ${pid} 2> /dev/null; then
+  echo "the run stopped"
+  exit 1
+fi
+if [ -e signals.yaml ]; then
+  echo "the final report is already there"
+  exit 1
+fi
+
+# SIGTERM finishes the current hand and writes the final report, with flat bets the mean is the bankroll over the hands
+echo "final report"
+sleep 1
+kill -TERM ${pid}
+wait ${pid}
+exitifwrong $?
+wait_for_report signals.yaml
+exitifwrong $?
+hands=$(yq .hands signals.yaml)
+mean=$(yq .mean signals.yaml)
+bankroll=$(yq .bankroll signals.yaml)
+echo " ${hands} hands, mean ${mean}, bankroll ${bankroll}"
+awk -v i="${interim}" -v n="${hands}" -v m="${mean}" -v b="${bankroll}" \
+    'BEGIN { d = m - b/n; exit !(i > 0 && n > i && n < 1e12 && d*d < 1e-14) }'
+exitifwrong $?
+
+rm -f signals-interim.yaml signals.yaml
+echo "ok"
@@ -0,0 +1,79 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+# a two-by-two grid in a single process
+cat > sweep.conf << EOF2
+hands = 20000
+rng_seed = 5
+sweep_threads = 2
+[sweep]
+decks = 1, 6
+rules = h17 das, s17 ndas
+EOF2
+
+echo "grid of four points"
+$blackjack -c sweep.conf --report=sweep.yaml
+exitifwrong $?
+points=$(yq '. | length' sweep.yaml)
+first=$(yq '.[0].decks' sweep.yaml)
+last=$(yq '.[3].decks' sweep.yaml)
+hands=$(yq '.[2].hands' sweep.yaml)
+s17=$(grep -c 'rules: "s17 ndas"' sweep.yaml)
+echo " ${points} points, from ${first} to ${last} decks, ${s17} with s17 ndas, ${hands} hands each"
+if [ "x${points}" != "x4" ] || [ "x${first}" != "x1" ] || [ "x${last}" != "x6" ] || [ "x${s17}" != "x2" ] || [ "x${hands}" != "x20000" ]; then
+  exit 1
+fi
+
+# the seeds come from rng_seed so the whole grid is reproducible, no matter the threads
+echo "determinism"
+$blackjack -c sweep.conf --report=sweep-again.yaml --sweep_threads=1
+cmp sweep.yaml sweep-again.yaml
+exitifwrong $?
+
+# a setting that does not change the game with the same seeds gives the very same hands
+echo "paired points"
+cat > sweep.conf << EOF2
+hands = 20000
+sweep_seeds = same
+sweep_format = tsv
+[sweep]
+error_standard_deviations = 1:1:3
+EOF2
+$blackjack -c sweep.conf --report=sweep.tsv
+exitifwrong $?
+rows=$(awk 'NR > 1' sweep.tsv | wc -l)
+means=$(awk -F'\t' 'NR == 1 { for (i = 1; i <= NF; i++) if ($i == "mean") c = i } NR > 1 { print $c }' sweep.tsv | sort -u | wc -l)
+echo " ${rows} rows with ${means} different means"
+if [ ${rows} -ne 3 ] || [ ${means} -ne 1 ]; then
+  exit 1
+fi
+
+# a betting progression starts afresh in every point, no matter which thread played the previous one
+echo "progressions"
+cat > sweep.conf << EOF2
+hands = 20000
+rng_seed = 5
+betting_system = martingale
+session_bankroll = 200
+[sweep]
+decks = 1, 6, 1
+EOF2
+$blackjack -c sweep.conf --report=sweep.yaml --sweep_threads=1
+exitifwrong $?
+$blackjack -c sweep.conf --report=sweep-again.yaml --sweep_threads=3
+exitifwrong $?
+cmp sweep.yaml sweep-again.yaml
+exitifwrong $?
+
+rm -f sweep.conf sweep.yaml sweep-again.yaml sweep.tsv
+echo "ok"
@@ -0,0 +1,52 @@
+#!/bin/sh
+for i in . tests; do
+  if [ -e ${i}/functions.sh ]; then
+    . ${i}/functions.sh
+  fi
+done
+if [ -z "${functions_found}" ]; then
+  echo "could not find functions.sh"
+   exit 1
+fi
+
+checkyq
+
+# a player that answers quickly never times out and its latency goes into the report
+echo "latency of a quick player"
+yes stand | $blackjack -n1000 --rng_seed=1 --flat_bet=true --no_insurance=true --decision_timeout=10 --report_verbosity=6 --report=timeout.yaml > /dev/null
+exitifwrong $?
+timeouts=$(yq .decision_timeouts timeout.yaml)
+decisions=$(yq .decisions timeout.yaml)
+p50=$(yq .decision_latency_p50_ns timeout.yaml)
+p99=$(yq .decision_latency_p99_ns timeout.yaml)
+max=$(yq .decision_latency_max_ns timeout.yaml)
+echo " ${decisions} decisions, ${timeouts} timeouts, p50 ${p50} p99 ${p99} max ${max} ns"
+awk -v t="${timeouts}" -v d="${decisions}" -v a="${p50}" -v b="${p99}" -v c="${max}" \
+    'BEGIN { exit !(t == 0 && d > 500 && a > 0 && a <= b && b <= c) }'
+exitifwrong $?
+
+# a player that always answers hit too late stands every hand, so it never busts
+# (if the late answers were taken for the next question it would)
+echo "late answers are dropped"
+while sleep 0.1; do echo hit; done | $blackjack -n40 --rng_seed=1 --flat_bet=true --no_insurance=true \
+          --decision_timeout=0.05 --decision_timeout_action=stand --report_verbosity=3 --report=timeout.yaml > /dev/null
+exitifwrong $?
+timeouts=$(yq .decision_timeouts timeout.yaml)
+late=$(yq .decision_late_answers timeout.yaml)
+busts=$(yq .busts_player_n timeout.yaml)
+echo " ${timeouts} timeouts, ${late} late answers, ${busts} busts"
+awk -v t="${timeouts}" -v l="${late}" -v b="${busts}" 'BEGIN { exit !(t > 30 && l > 5 && b == 0) }'
+exitifwrong $?
+
+# when the basic fallback answers every question the game is the same as the internal player's
+echo "basic strategy fallback"
+while sleep 1; do echo stand; done | $blackjack -n200 --rng_seed=3 --flat_bet=true --no_insurance=true \
+          --decision_timeout=0.005 --report_verbosity=3 --report=timeout.yaml > /dev/null
+exitifwrong $?
+$blackjack -i -n200 --rng_seed=3 --report_verbosity=3 --report=internal.yaml
+exitifwrong $?
+grep -v "^decision_" timeout.yaml | diff - internal.yaml
+exitifwrong $?
+
+rm -f timeout.yaml internal.yaml
+echo "ok"